@@ -0,0 +1,45 @@
+#include "include/bench.h"
+
+#define LOG_LEVEL msg_very_verbose
+
+int main(int argc, char *argv[])
+{
+    uint32_t max_k = UINT32_MAX;
+    uint32_t max_n = UINT32_MAX;
+
+    set_messaging_level(LOG_LEVEL);
+
+    alloc_profiler_install();
+
+    if (argc > 1)
+        max_k = strtoul(argv[1], NULL, 10);
+
+    if (argc > 2)
+        max_n = strtoul(argv[2], NULL, 10);
+
+    bench_primitives(max_k, max_n);
+
+    bench_sign_batch();
+
+    bench_sign_quorum();
+
+    bench_keygen_seeded();
+
+    bench_evolver();
+
+#ifndef USE_POLYNOMIAL
+    bench_keygen_distributed();
+    bench_sign_checked();
+#endif
+
+#ifdef USE_POLYNOMIAL
+    bench_sign_beaver();
+    bench_update_packed();
+#endif
+
+    bench_random();
+
+    bench_transport();
+
+    bench_runtime(max_n);
+}
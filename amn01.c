@@ -7,13 +7,35 @@ int main()
 {
     set_messaging_level(LOG_LEVEL);
 
+    alloc_profiler_install();
+
     bench_sign();
 
     test_simple_sign_verify();
     test_round_update_sign_verify();
+    test_update_to_sign_verify();
+    test_runtime_sign_verify();
+    test_transport_large_messages();
+    test_sign_batch_verify();
+    test_concurrent_sessions_sign_verify();
+    test_random_backends_sign_verify();
+    test_fixed_limb_consistency();
+    test_simd_mont_consistency();
+    test_verify_parallel_sign_verify();
+    test_key_store_layout();
+    test_shamir_consistency();
+    test_sign_quorum_verify();
+    test_beaver_sign_verify();
+    test_packed_sign_verify();
+    test_seeded_keygen_sign_verify();
     test_forge_sign_verify();
+    test_evolver_sign_verify();
 
-#ifndef USE_POLYNOMIAL
+#ifdef USE_POLYNOMIAL
+    test_evolver_packed_sign_verify();
+#else
     test_refresh_sign_verify();
+    test_distributed_keygen_sign_verify();
+    test_partial_verify_sign_verify();
 #endif
 }
\ No newline at end of file
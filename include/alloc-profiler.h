@@ -0,0 +1,77 @@
+#ifndef ALLOC_PROFILER_H
+#define ALLOC_PROFILER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Allocation counters collected between `alloc_profiler_begin` and `alloc_profiler_end`.
+ *
+ * Sizes are the usable sizes of the blocks returned by the system allocator.
+ */
+typedef struct
+{
+    uint64_t allocations;
+    uint64_t reallocations;
+    uint64_t frees;
+    uint64_t bytes;
+    uint64_t peak;
+    int64_t live;
+} alloc_profile_t;
+
+#ifdef USE_ALLOC_PROFILER
+
+/**
+ * @brief Routes every GMP allocation through the profiler with `mp_set_memory_functions`.
+ *
+ * The hooks only account and then forward to the system allocator, so it is safe to install
+ * them while GMP values allocated before are still alive.
+ */
+void alloc_profiler_install();
+
+/**
+ * @brief Starts a measurement window, resetting the counters and the peak footprint.
+ */
+void alloc_profiler_begin();
+
+/**
+ * @brief Ends the measurement window started by `alloc_profiler_begin`.
+ *
+ * @param[out] profile The counters of the window; `peak` and `live` are relative to the footprint at its start.
+ */
+void alloc_profiler_end(alloc_profile_t *profile);
+
+/**
+ * @brief Prints the counters of a measurement window.
+ */
+void fprintf_alloc_profile(FILE *stream, const char *name, const alloc_profile_t *profile);
+
+void *alloc_profiler_malloc(size_t size);
+void *alloc_profiler_calloc(size_t count, size_t size);
+void *alloc_profiler_realloc(void *ptr, size_t size);
+void *alloc_profiler_aligned_alloc(size_t alignment, size_t size);
+void alloc_profiler_free(void *ptr);
+
+#define printf_alloc_profile(NAME, PROFILE) fprintf_alloc_profile(stdout, NAME, PROFILE)
+
+#ifndef ALLOC_PROFILER_IMPLEMENTATION
+/* the library's own allocations are accounted as well */
+#define malloc(size) alloc_profiler_malloc(size)
+#define calloc(count, size) alloc_profiler_calloc(count, size)
+#define realloc(ptr, size) alloc_profiler_realloc(ptr, size)
+#define aligned_alloc(alignment, size) alloc_profiler_aligned_alloc(alignment, size)
+#define free(ptr) alloc_profiler_free(ptr)
+#endif
+
+#else
+
+#define alloc_profiler_install() ((void)0)
+#define alloc_profiler_begin() ((void)0)
+#define alloc_profiler_end(profile) ((void)(profile))
+#define fprintf_alloc_profile(stream, name, profile) ((void)0)
+#define printf_alloc_profile(NAME, PROFILE) ((void)0)
+
+#endif
+
+#endif // ALLOC_PROFILER_H
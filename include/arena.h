@@ -0,0 +1,61 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <gmp.h>
+
+#define ARENA_CHUNK_SIZE (1 << 20)
+#define ARENA_MAX_CHUNKS 256
+#define ARENA_ALIGNMENT 16
+#define ARENA_SIZE_CLASSES 256
+
+#ifdef USE_ARENA
+
+/**
+ * @brief Starts an arena scope on the calling thread.
+ *
+ * Until the matching `arena_scope_end`, every GMP allocation made by this thread is served by
+ * a thread-local bump allocator. Freed blocks are recycled through per-size free lists and
+ * the whole arena is wiped and rewound when the outermost scope ends. Scopes can be nested.
+ *
+ * Values that must outlive the scope have to be created or grown while the scope is
+ * suspended, see `arena_scope_suspend` and `arena_copy_out`.
+ */
+void arena_scope_begin();
+
+/**
+ * @brief Ends an arena scope; the outermost one wipes and rewinds the arena.
+ */
+void arena_scope_end();
+
+/**
+ * @brief Temporarily routes the GMP allocations of the calling thread back to the system allocator.
+ */
+void arena_scope_suspend();
+
+/**
+ * @brief Resumes the arena scope suspended by `arena_scope_suspend`.
+ */
+void arena_scope_resume();
+
+/**
+ * @brief Copies `src` into a value `dst` that outlives the current arena scope.
+ */
+#define arena_copy_out(dst, src) \
+    do                           \
+    {                            \
+        arena_scope_suspend();   \
+        mpz_set(dst, src);       \
+        arena_scope_resume();    \
+    } while (0)
+
+#else
+
+#define arena_scope_begin() ((void)0)
+#define arena_scope_end() ((void)0)
+#define arena_scope_suspend() ((void)0)
+#define arena_scope_resume() ((void)0)
+#define arena_copy_out(dst, src) mpz_set(dst, src)
+
+#endif
+
+#endif // ARENA_H
@@ -0,0 +1,113 @@
+#ifndef BEAVER_H
+#define BEAVER_H
+
+#include "context.h"
+#include "utils.h"
+
+// triples generated by each resharing round of the producer
+#define BEAVER_BATCH 16
+
+#define BEAVER_DEFAULT_CAPACITY 256
+
+typedef enum
+{
+    BEAVER_SQUARE,  // b = a, for the squaring chains
+    BEAVER_PRODUCT
+} beaver_kind_t;
+
+/**
+ * @brief Shares of random a, b and of c = a * b, one per player on the abscissas 1, ..., n.
+ */
+typedef struct
+{
+    mpz_point_t *a;
+    mpz_point_t *b;
+    mpz_point_t *c;
+} beaver_triple_t;
+
+typedef struct
+{
+    beaver_triple_t *triples;
+    uint32_t head;
+    uint32_t count;
+} beaver_ring_t;
+
+/**
+ * @brief Multiplication triples generated ahead of time by a background thread.
+ *
+ * The producer keeps a ring of square triples and one of product triples filled up to
+ * `capacity`, batching `BEAVER_BATCH` triples per resharing round with `mult_shamir_ss_batch`;
+ * once both are full it waits for one of them to be half empty.
+ * A multiplication that consumes a triple only opens the masked operands and combines the
+ * shares locally, see `beaver_mult`. The pool can be shared by threads.
+ */
+typedef struct
+{
+    uint32_t n;
+    uint32_t threshold;
+    uint32_t capacity;
+
+    mpz_t N;
+    mpz_t *lambda; // Lagrange coefficients at zero of the abscissas 1, ..., n, for the openings
+    gmp_randstate_t prng; // used by the producer only
+
+    beaver_ring_t rings[2]; // indexed by beaver_kind_t
+
+    pthread_t producer;
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+    pthread_cond_t drained;
+    uint8_t stop;
+    uint8_t refill; // set by beaver_pool_wait_full to wake the producer above the low mark
+
+    uint64_t generated;
+    double offline_seconds; // spent by the producer generating triples
+} beaver_pool_t;
+
+/**
+ * @brief Creates a pool for the key of `pk` and starts its producer.
+ *
+ * @param[in] ctx The protocol parameters, the random state of the producer is derived from its own.
+ * @param[in] capacity The number of triples of each kind kept ready.
+ * @return Pointer to the new pool.
+ */
+beaver_pool_t *beaver_pool_new(context_t *ctx, public_key_t *pk, uint32_t capacity);
+
+/**
+ * @brief Stops the producer and frees the pool with the triples left.
+ */
+void beaver_pool_free(beaver_pool_t *pool);
+
+/**
+ * @brief Has the producer top up both rings of the pool and waits until they are full.
+ */
+void beaver_pool_wait_full(beaver_pool_t *pool);
+
+/**
+ * @brief Takes a triple out of the pool, waiting for the producer if the ring is empty.
+ *
+ * The triple belongs to the caller and is released with `beaver_triple_clear`.
+ */
+void beaver_pool_take(beaver_pool_t *pool, beaver_kind_t kind, beaver_triple_t *triple);
+
+void beaver_triple_clear(beaver_triple_t *triple, uint32_t n);
+
+/**
+ * @brief Sets `dst` to shares of x * y consuming a triple of the pool.
+ *
+ * With d = x - a and e = y - b opened, the shares of the product are c + d * b + e * a + d * e,
+ * of the same degree as the operands; when `x` and `y` are the same array a square triple is
+ * used and a single value is opened. `dst` may alias `x` or `y`.
+ *
+ * @param[out] dst The n shares of the product, on the abscissas 1, ..., n.
+ * @param[in] x The n shares of the first operand.
+ * @param[in] y The n shares of the second operand.
+ */
+void beaver_mult(beaver_pool_t *pool, mpz_point_t *dst, mpz_point_t *x, mpz_point_t *y);
+
+/**
+ * @brief Reconstructs the value of n shares on the abscissas 1, ..., n.
+ */
+void beaver_open(beaver_pool_t *pool, mpz_t dst, mpz_point_t *shares);
+
+#endif // BEAVER_H
@@ -1,4 +1,126 @@
 #include "scheme.h"
 #include "../lib/lib-timing.h"
 
+#define BENCH_PRIMITIVES_SAMPLING_TIME 1 /* secondi */
+#define BENCH_PRIMITIVES_MAX_SAMPLES (BENCH_PRIMITIVES_SAMPLING_TIME * 1000)
+#define BENCH_SQUARE_BATCH_VALUES 8
+#define BENCH_SQUARE_BATCH_SQUARINGS 64
+
+#define BENCH_RUNTIME_SAMPLING_TIME 2 /* secondi */
+#define BENCH_RUNTIME_MAX_SAMPLES (BENCH_RUNTIME_SAMPLING_TIME * 1000)
+
+#define BENCH_TRANSPORT_SAMPLING_TIME 1 /* secondi */
+#define BENCH_TRANSPORT_MAX_SAMPLES (BENCH_TRANSPORT_SAMPLING_TIME * 100000)
+#define BENCH_TRANSPORT_STREAM_MESSAGES 4096
+
+#define BENCH_RANDOM_SAMPLING_TIME 1 /* secondi */
+#define BENCH_RANDOM_MAX_SAMPLES (BENCH_RANDOM_SAMPLING_TIME * 1000)
+#define BENCH_RANDOM_VALUES 1024
+
+#define BENCH_SIGN_QUORUM_SIGNATURES 64
+#define BENCH_SIGN_BEAVER_SIGNATURES 32
+#define BENCH_UPDATE_PACKED_ROUNDS 8
+#define BENCH_KEYGEN_SEEDED_PLAYERS 64
+#define BENCH_KEYGEN_DISTRIBUTED_MAX_N 64
+#define BENCH_EVOLVER_PERIODS 8
+#define BENCH_EVOLVER_PERIOD_SIGNATURES 16
+#define BENCH_EVOLVER_INTERVAL_US 2000
+#define BENCH_SIGN_CHECKED_SIGNATURES 16
+
 void bench_sign();
+
+/**
+ * @brief Compares the throughput of `sign_batch` with a loop of `sign` for batches of 1 to 1024
+ * messages, on a single core.
+ */
+void bench_sign_batch();
+
+/**
+ * @brief Compares the throughput of `sign` with all the players and of `sign_quorum` with the
+ * smallest quorum (2t - 1 players in the polynomial scheme), for n = 9 and t = 3.
+ */
+void bench_sign_quorum();
+
+/**
+ * @brief Compares `keygen` with `keygen_seeded` for `BENCH_KEYGEN_SEEDED_PLAYERS` players: the
+ * time, modulus generation included, and the bytes handed out by the dealer.
+ */
+void bench_keygen_seeded();
+
+/**
+ * @brief Compares the signing latency across period boundaries, every
+ * `BENCH_EVOLVER_PERIOD_SIGNATURES` signatures requested every `BENCH_EVOLVER_INTERVAL_US`, of
+ * a loop calling `update` inline with the one of an `evolver_t` computing the next period in the
+ * background.
+ */
+void bench_evolver();
+
+#ifndef USE_POLYNOMIAL
+
+/**
+ * @brief Compares, for 4 to `BENCH_KEYGEN_DISTRIBUTED_MAX_N` players, the dealer work of `keygen`
+ * with the steps of `keygen_distributed`: the partials of one player and the combine.
+ */
+void bench_keygen_distributed();
+
+/**
+ * @brief Compares the latency of `sign` with the one of `sign_checked`, with honest players and
+ * with a faulty one, for which the contributions are checked with `verify_partials`.
+ */
+void bench_sign_checked();
+
+#endif
+
+#ifdef USE_POLYNOMIAL
+
+/**
+ * @brief Compares the latency of `sign` with the online latency of `sign_beaver` on a full pool,
+ * and reports the offline cost of the triples.
+ */
+void bench_sign_beaver();
+
+/**
+ * @brief Reports, for every packing factor that fits n = 16 and t = 3, the key storage per
+ * player and the latency of a period transition with `update_packed` and of `sign_packed`.
+ */
+void bench_update_packed();
+
+#endif
+
+/**
+ * @brief Benchmarks each arithmetic primitive of `utils.c` in isolation.
+ *
+ * Every primitive is sampled for each modulus size up to `max_k` bits and, where it depends
+ * on the number of shares, for each share count up to `max_n`.
+ *
+ * @param[in] max_k The largest modulus size (in bits) to benchmark.
+ * @param[in] max_n The largest number of shares to benchmark.
+ */
+void bench_primitives(uint32_t max_k, uint32_t max_n);
+
+/**
+ * @brief Benchmarks the protocol steps run by the multi-party runtime.
+ *
+ * For each number of players up to `max_n` the steps are timed over both transports and
+ * their communication cost (bytes, messages and rounds) is reported.
+ *
+ * @param[in] max_n The largest number of players to benchmark.
+ */
+void bench_runtime(uint32_t max_n);
+
+/**
+ * @brief Benchmarks the transports alone between two threads.
+ *
+ * For each message size the round trip latency and the one-way streaming throughput are
+ * reported for every transport kind.
+ */
+void bench_transport();
+
+/**
+ * @brief Compares the random backends.
+ *
+ * For each backend `keygen` and `sign` of the compiled scheme are timed with the protocol
+ * random state on that backend, together with `BENCH_RANDOM_VALUES` draws modulo N made one
+ * at a time and in bulk.
+ */
+void bench_random();
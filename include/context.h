@@ -14,10 +14,26 @@ typedef struct
     gmp_randstate_t prng;
 } context_t;
 
+/**
+ * @brief Values modulo N kept in one slab of limbs, see key-store.h.
+ */
+typedef struct
+{
+    mp_limb_t *limbs;
+    mpz_t *views;
+
+    uint32_t count;
+    uint32_t stride; // limbs per slot
+} key_store_t;
+
 typedef struct
 {
     mpz_t N;
-    mpz_t *S;
+    mpz_t *S; // view of the player's row of the shared store
+
+    key_store_t *store; // the shares of all the players, one row of l per player
+
+    uint32_t packing; // key components per share, 1 unless dealt by keygen_packed
 
     uint32_t T;
     uint32_t j;
@@ -26,7 +42,12 @@ typedef struct
 typedef struct
 {
     mpz_t N;
-    mpz_t *U;
+    mpz_t *U; // view of the whole store
+
+    key_store_t *store;
+
+    mpz_t *V;                  // view of the verification store, NULL without per-player keys
+    key_store_t *verification; // the partial components S_{p,i}^(2^(T + 1)), one row of l per player
 
     uint32_t T;
 } public_key_t;
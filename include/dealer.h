@@ -1,12 +1,15 @@
 #include "utils.h"
 #include "context.h"
+#include "key-store.h"
+#include "parallel.h"
 
 /**
  * @brief Sets the public key modulo (N) as the product of two distinct prime numbers.
  *
  * This function generates two distinct prime numbers p and q, each with half the bit-length
  * specified in the protocol parameters, and sets the value of the public key modulo N
- * as the product of these two primes.
+ * as the product of these two primes. The two primes are searched concurrently, each with
+ * its own random state seeded from the context one.
  *
  */
 void dealer_init_modulo(context_t *ctx, public_key_t *pk);
@@ -18,15 +21,37 @@ void dealer_init_modulo(context_t *ctx, public_key_t *pk);
  * and secret parameters. The secret key includes the public modulo (N), the current round,
  * and an array of secret values (S) of lenght l.
  *
+ * The secret values of all the players live in one key store, a row of l slots per player:
+ * S is the player's row and the store is shared through `sk.store`.
+ *
  */
 void dealer_init_players(context_t *ctx, public_key_t *pk, player_t *players);
 
+/**
+ * @brief Same as `dealer_init_players`, for secret keys packing `packing` components per share.
+ *
+ * Each row of the store holds the ceil(l / packing) shares of a player.
+ *
+ */
+void dealer_init_players_packed(context_t *ctx, public_key_t *pk, player_t *players, uint32_t packing);
+
 /**
  * @brief Initialize public parameters in the protocol.
  *
+ * The l public components are the views of a key store of their own.
+ *
  */
 void dealer_init_pk(context_t *ctx, public_key_t *pk);
 
+/**
+ * @brief Computes the per-player verification keys of the multiplicative scheme.
+ *
+ * V_{p,i} = S_{p,i}^(2^(T + 1)) for the shares dealt to the players, kept in a key store of
+ * their own with a row of l per player. The public component i is the product of the V_{p,i},
+ * see `dealer_multiplicative_combine_public_key_i`.
+ */
+void dealer_multiplicative_init_verification_keys(context_t *ctx, public_key_t *pk, player_t *players);
+
 /**
  * @brief Sets a random value in player's secret key that is coprime with the public modulo.
  *
@@ -36,7 +61,6 @@ void dealer_init_pk(context_t *ctx, public_key_t *pk);
  */
 static inline __attribute__((always_inline)) void dealer_set_player_private_key_i(context_t *ctx, secret_key_t player_sk, uint32_t key_idx)
 {
-    mpz_init(player_sk.S[key_idx]);
     mpz_set_random_n_coprime(player_sk.S[key_idx], player_sk.N, ctx->prng);
 }
 
@@ -48,17 +72,46 @@ static inline __attribute__((always_inline)) void dealer_set_player_private_key_
  */
 static inline __attribute__((always_inline)) void dealer_multiplicative_compute_public_key_i(context_t *ctx, public_key_t *pk, player_t *players, uint32_t key_idx)
 {
-    mpz_init(pk->U[key_idx]);
+    key_store_t *store = players[0].sk.store;
 
-    mpz_set(pk->U[key_idx], players[0].sk.S[key_idx]);
+    // the product outgrows the slot before each reduction
+    mpz_t product;
+    mpz_init_set(product, key_store_at(store, 0, ctx->l, key_idx));
 
     for (uint32_t i = 1; i < ctx->n; i++)
     {
-        mpz_mul(pk->U[key_idx], pk->U[key_idx], players[i].sk.S[key_idx]);
-        mpz_mod(pk->U[key_idx], pk->U[key_idx], pk->N);
+        mpz_mul(product, product, key_store_at(store, i, ctx->l, key_idx));
+        mpz_mod(product, product, pk->N);
     }
 
-    mpz_double_pow(pk->U[key_idx], pk->T, 0, pk->N);
+    mpz_double_pow(product, pk->T, 0, pk->N);
+    mpz_set(pk->U[key_idx], product);
+
+    mpz_clear(product);
+}
+
+/**
+ * @brief Combines the partial public components published by the players for a specific index.
+ *
+ * @param partials The partials of all the players, a row of l per player.
+ * @param key_idx The index of the public key value to be computed.
+ *
+ */
+static inline __attribute__((always_inline)) void dealer_multiplicative_combine_public_key_i(context_t *ctx, public_key_t *pk, key_store_t *partials, uint32_t key_idx)
+{
+    // the product outgrows the slot before each reduction
+    mpz_t product;
+    mpz_init_set(product, key_store_at(partials, 0, ctx->l, key_idx));
+
+    for (uint32_t i = 1; i < ctx->n; i++)
+    {
+        mpz_mul(product, product, key_store_at(partials, i, ctx->l, key_idx));
+        mpz_mod(product, product, pk->N);
+    }
+
+    mpz_set(pk->U[key_idx], product);
+
+    mpz_clear(product);
 }
 
 /**
@@ -67,7 +120,7 @@ static inline __attribute__((always_inline)) void dealer_multiplicative_compute_
  */
 static inline __attribute__((always_inline)) void dealer_polynomial_compute_public_key_i(public_key_t *pk, mpz_t s, uint32_t key_idx)
 {
-    mpz_init_set(pk->U[key_idx], s);
+    mpz_set(pk->U[key_idx], s);
 
     mpz_double_pow(pk->U[key_idx], pk->T, 0, pk->N);
 }
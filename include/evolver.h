@@ -0,0 +1,105 @@
+#ifndef EVOLVER_H
+#define EVOLVER_H
+
+#include <stdatomic.h>
+
+#include "scheme.h"
+
+/**
+ * @brief One copy of the players' shares, for a single period.
+ */
+typedef struct
+{
+    player_t *players;
+    key_store_t *store; // the shares of the players, one row of l per player
+
+    atomic_uint readers; // signers pinning the state, see `evolver_acquire`
+} evolver_state_t;
+
+/**
+ * @brief Double-buffered key evolution on a background thread.
+ *
+ * The manager owns two copies of the shares: the current one, that signers pin while they
+ * sign, and a shadow one into which the worker computes the next period with `update` (or
+ * `update_packed`) while the signers go on. At the period boundary `evolver_advance` swaps the
+ * current pointer atomically. The old period is wiped as soon as no signer pins it, by the last
+ * one to unpin it or by `evolver_advance` itself, without waiting for the worker, which then
+ * computes the following period into it.
+ *
+ * Signers never take the lock: pinning is an atomic increment, checked against the current
+ * pointer. The public key is only read, so `refresh` must not run while the manager owns the
+ * shares.
+ */
+typedef struct
+{
+    context_t ctx; // copy of the parameters with the worker's own random state
+    public_key_t *pk;
+
+    evolver_state_t states[2];
+    _Atomic(evolver_state_t *) current;
+
+    pthread_t worker;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint8_t stop;
+    uint8_t ready; // the shadow state holds the next period
+    uint8_t stale;   // the shadow state has to be replaced with the next period, cleared by the worker
+    uint8_t retired; // the shadow state still holds the previous period, until it is wiped
+
+    uint32_t transitions;
+    double offline_seconds; // spent by the worker computing the next periods
+} evolver_t;
+
+/**
+ * @brief Creates a manager for dealt players and starts its worker on the next period.
+ *
+ * The manager takes the players over until `evolver_free`.
+ *
+ * @param[in] ctx The protocol parameters, the random state of the worker is derived from its own.
+ * @param[in] pk The public key, only read.
+ * @param[in] players The players holding the shares of the key.
+ * @return Pointer to the new manager.
+ */
+evolver_t *evolver_new(context_t *ctx, public_key_t *pk, player_t *players);
+
+/**
+ * @brief Stops the worker, wipes the shadow state and frees the manager.
+ *
+ * No signer may hold a state.
+ *
+ * @return The players of the current period, to be released with `cleanup`.
+ */
+player_t *evolver_free(evolver_t *evolver);
+
+/**
+ * @brief Pins the players of the current period, they stay valid until `evolver_release`.
+ */
+player_t *evolver_acquire(evolver_t *evolver);
+
+/**
+ * @brief Unpins players returned by `evolver_acquire`.
+ *
+ * The last signer to unpin a period that has been swapped out wipes its shares.
+ */
+void evolver_release(evolver_t *evolver, player_t *players);
+
+/**
+ * @brief Switches to the next period, waiting for the worker only if it has not finished it yet.
+ *
+ * Signers that pinned the old period finish with it; its shares are wiped here if there are
+ * none, otherwise by the last of them in `evolver_release`.
+ *
+ * @return 1 if the period has changed, 0 if the final period has been reached.
+ */
+uint8_t evolver_advance(evolver_t *evolver);
+
+/**
+ * @brief Signs a message in the current period, see `sign` (or `sign_packed` for packed keys).
+ *
+ * @param[in] ctx The parameters of the signer, whose random state is used.
+ * @param[in] m The message to be signed.
+ * @return Pointer to the generated signature.
+ */
+signature_t *evolver_sign(evolver_t *evolver, context_t *ctx, const char *m);
+
+#endif // EVOLVER_H
@@ -0,0 +1,64 @@
+#ifndef FIXED_LIMB_H
+#define FIXED_LIMB_H
+
+#include <gmp.h>
+#include <stdint.h>
+
+// moduli sizes (in limbs) with a specialized Montgomery arithmetic: k = 1024, 2048, 3072, 4096
+#define FIXED_LIMB_MAX 64
+
+/**
+ * @brief Montgomery arithmetic on flat limb arrays for a modulus of a specialized size.
+ *
+ * Values are `size` limbs in Montgomery form (x * B^size mod N, B = 2^GMP_NUMB_BITS), not
+ * always fully reduced but always below B^size. The products go through GMP's `mpn_` layer
+ * into `scratch`, which is sized once for the largest modulus, and the reduction has the
+ * number of limbs fixed at compile time.
+ *
+ * With `USE_FIXED_LIMB` the exponentiations of `utils.c` and of the multiplicative `update_to`
+ * run on it, and fall back to `mpz_` for the other sizes.
+ */
+typedef struct
+{
+    uint32_t size;
+
+    mp_limb_t N[FIXED_LIMB_MAX];
+    mp_limb_t R2[FIXED_LIMB_MAX]; // B^(2 * size) mod N
+    mp_limb_t ninv; // -1/N mod B
+
+    void (*mul)(const mp_limb_t *N, mp_limb_t ninv, mp_limb_t *dst, const mp_limb_t *a, const mp_limb_t *b, mp_limb_t *scratch);
+    void (*sqr)(const mp_limb_t *N, mp_limb_t ninv, mp_limb_t *dst, const mp_limb_t *a, mp_limb_t *scratch);
+
+    mp_limb_t scratch[2 * FIXED_LIMB_MAX];
+} fixed_limb_t;
+
+/**
+ * @brief Returns the arithmetic for `N`, or NULL when the size of `N` is not specialized.
+ *
+ * The arithmetic of the last modulus is cached per thread, so the returned pointer is only
+ * valid on the calling thread and until it asks for a different modulus.
+ */
+fixed_limb_t *fixed_limb_get(const mpz_t N);
+
+/**
+ * @brief Sets `dst` to `dst^(2^squarings) mod N`.
+ *
+ * @return 1 on success, 0 (leaving `dst` untouched) if `N` or `dst` does not fit a specialized size.
+ */
+uint8_t fixed_limb_double_pow(mpz_t dst, uint32_t squarings, const mpz_t N);
+
+/**
+ * @brief Sets every value to `value^(2^squarings) mod N`.
+ *
+ * @return 1 on success, 0 (leaving the values untouched) if `N` or a value does not fit a specialized size.
+ */
+uint8_t fixed_limb_double_pow_batch(mpz_t *values, uint32_t count, uint32_t squarings, const mpz_t N);
+
+/**
+ * @brief Sets `dst` to `base * prod(key_i^c_i) mod N` for bits `c_i`, see `mpz_mmul_pow_array`.
+ *
+ * @return 1 on success, 0 (leaving `dst` untouched) if `N` or an operand does not fit a specialized size.
+ */
+uint8_t fixed_limb_mmul_pow_array(mpz_t dst, const mpz_t base, const uint8_t *c, const mpz_t *key, uint32_t l, const mpz_t N);
+
+#endif // FIXED_LIMB_H
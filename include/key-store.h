@@ -0,0 +1,60 @@
+#ifndef KEY_STORE_H
+#define KEY_STORE_H
+
+#include "context.h"
+
+// slots start on a cache line
+#define KEY_STORE_ALIGNMENT 64
+
+/**
+ * @brief Allocates a store of `count` values modulo `N` in one slab.
+ *
+ * Every slot is a `mpz_t` view whose limbs live in the slab at a fixed stride: one limb more
+ * than `N` (the SIMD kernels may write a limb of leading zeros), rounded up to a cache line.
+ * The views start at zero and can be used with any `mpz_` function whose result is reduced
+ * modulo `N`, since GMP never needs to grow them; anything larger (a product before the
+ * reduction) must go through a temporary and be copied in with `mpz_set`.
+ *
+ * The views are never passed to `mpz_init` or `mpz_clear`: the whole store is released with
+ * `key_store_free`.
+ *
+ * @param[in] count The number of slots.
+ * @param[in] N The modulus bounding the stored values.
+ * @return Pointer to the new store.
+ */
+key_store_t *key_store_new(uint32_t count, const mpz_t N);
+
+/**
+ * @brief Wipes and frees the store, its views included.
+ */
+void key_store_free(key_store_t *store);
+
+/**
+ * @brief Sets every slot of the store to zero, wiping the limbs.
+ */
+void key_store_wipe(key_store_t *store);
+
+/**
+ * @brief Copies the values of `src` into `dst`, a store of the same count and stride.
+ *
+ * @return 1 on success, 0 (nothing copied) if the stores differ in count or stride.
+ */
+uint8_t key_store_copy(key_store_t *dst, const key_store_t *src);
+
+/**
+ * @brief Returns the `count` contiguous views starting at slot `first`.
+ */
+static inline mpz_t *key_store_views(key_store_t *store, uint32_t first)
+{
+    return store->views + first;
+}
+
+/**
+ * @brief Returns the view of component `idx` of row `row`, for a store of rows of `width` slots.
+ */
+static inline mpz_ptr key_store_at(key_store_t *store, uint32_t row, uint32_t width, uint32_t idx)
+{
+    return store->views[row * width + idx];
+}
+
+#endif // KEY_STORE_H
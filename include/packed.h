@@ -0,0 +1,116 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include <gmp.h>
+#include <stdint.h>
+
+#include "utils.h"
+
+// largest number of secrets in one packed sharing
+#define PACKED_MAX_FACTOR 16
+
+/**
+ * @brief Packed Shamir sharing of `factor` secrets on the abscissas 1, ..., n.
+ *
+ * The secrets are the values of one polynomial at the slots -1, ..., -factor:
+ *
+ *     g(x) = sum_s v_s * L_s(x) + Z(x) * rho(x)
+ *
+ * where L_s is the Lagrange basis of the slots, Z(x) = prod_s (x + s + 1) vanishes on them and
+ * rho is a random polynomial with `threshold - 1` coefficients, so that any `threshold - 1`
+ * shares reveal nothing as with `shamir_ss`. The degree is `threshold + factor - 2`, and a
+ * product of two sharings, of twice that degree, must still be interpolated from the n shares:
+ * see `packed_fits`.
+ *
+ * The coefficients depend only on n, the threshold, the factor and N and are computed once.
+ */
+typedef struct
+{
+    uint32_t n;
+    uint32_t threshold;
+    uint32_t factor;
+    uint32_t degree;
+    uint32_t width; // shares used to interpolate a product, 2 * degree + 1
+
+    mpz_t N;
+
+    mpz_t *basis;     // n x factor: L_s(k + 1)
+    mpz_t *vanishing; // n: Z(k + 1), small integers
+    mpz_t *open;      // factor x width: Lagrange coefficients at slot s of the abscissas 1, ..., width
+} packed_t;
+
+/**
+ * @brief Returns 1 if `factor` secrets can be packed in a sharing among `n` players with `threshold`.
+ */
+static inline uint8_t packed_fits(uint32_t n, uint32_t threshold, uint32_t factor)
+{
+    return factor > 0 && factor <= PACKED_MAX_FACTOR && threshold > 0 && 2 * (threshold + factor - 2) + 1 <= n;
+}
+
+/**
+ * @brief Returns the largest packing factor that fits `n` players with `threshold`, 0 if none.
+ */
+static inline uint32_t packed_max_factor(uint32_t n, uint32_t threshold)
+{
+    uint32_t factor = 0;
+
+    while (packed_fits(n, threshold, factor + 1))
+        factor++;
+
+    return factor;
+}
+
+/**
+ * @brief Returns the coefficients for the given parameters, or NULL if they do not fit.
+ *
+ * The coefficients of the last parameters are cached per thread, so the returned pointer is
+ * only valid on the calling thread and until it asks for different parameters.
+ */
+packed_t *packed_get(uint32_t n, uint32_t threshold, uint32_t factor, const mpz_t N);
+
+/**
+ * @brief Empties the cache of the calling thread.
+ */
+void packed_cache_clear();
+
+/**
+ * @brief Deals a packed sharing of `count` values, the remaining slots are zero.
+ *
+ * @param[out] shares The n shares, initialized by the caller.
+ * @param[in] values The values of the first `count` slots, `count` at most `factor`.
+ */
+void packed_share(packed_t *p, mpz_t *shares, const mpz_t *values, uint32_t count, gmp_randstate_t prng);
+
+/**
+ * @brief Recovers the `factor` slots from the first `width` shares.
+ *
+ * The shares may come from a product of two packed sharings. The protocols never open a pack,
+ * this is for tests.
+ *
+ * @param[out] values The `factor` slots, initialized by the caller.
+ */
+void packed_open(packed_t *p, mpz_t *values, const mpz_t *shares);
+
+/**
+ * @brief Turns one slot of a packed sharing into a plain Shamir sharing, as `shamir_ss` would deal it.
+ *
+ * The slot is never recovered: every one of the first `width` players multiplies its share by
+ * its coefficient of the slot, a local linear map, and reshares the result with
+ * `joint_shamir_ss_at`.
+ *
+ * @param[in, out] dst The n points, initialized by the caller with the abscissas 1, ..., n.
+ * @param[in] shares The n shares of the pack.
+ * @param[in] slot The slot to unpack, less than `factor`.
+ */
+void packed_unpack(packed_t *p, mpz_point_t *dst, const mpz_t *shares, uint32_t slot, gmp_randstate_t prng);
+
+/**
+ * @brief Squares every slot of a packed sharing `rounds` times, in place.
+ *
+ * Each round squares the shares locally and reduces the degree with one resharing for the
+ * whole pack: every one of the first `width` players deals a pack of its squared share times
+ * its coefficient of each slot, with a rho of its own, and the players add up what they receive.
+ */
+void packed_square(packed_t *p, mpz_t *shares, uint32_t rounds, gmp_randstate_t prng);
+
+#endif // PACKED_H
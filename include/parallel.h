@@ -0,0 +1,31 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdint.h>
+
+#define PARALLEL_MAX_WORKERS 64
+
+/**
+ * @brief Body of a parallel loop, called once for each index.
+ *
+ * @param[in] idx The index of the iteration.
+ * @param[in] arg The argument given to `parallel_for`.
+ */
+typedef void (*parallel_body_t)(uint32_t idx, void *arg);
+
+/**
+ * @brief Runs `body(i, arg)` for every i in [0, count) on the shared worker pool.
+ *
+ * The pool has one worker less than the online CPUs and is started on first use; the calling
+ * thread takes part in the loop and returns once every iteration is completed. Loops started
+ * from inside a body, or while the pool is serving another thread, run sequentially on the
+ * calling thread.
+ */
+void parallel_for(uint32_t count, parallel_body_t body, void *arg);
+
+/**
+ * @brief Returns the number of threads that take part in a `parallel_for` (workers and caller).
+ */
+uint32_t parallel_threads();
+
+#endif // PARALLEL_H
@@ -43,78 +43,77 @@ static inline __attribute__((always_inline)) void player_multiplicative_compute_
 }
 
 /**
- * @brief Generates random values such that their product is congruent to one modulo N.
+ * @brief Multiplies the verification keys of a player by the power of its refresh factor.
  *
- * Initializes an array of random values, ensuring their product is congruent to one modulo N.
+ * The refreshed shares of the player are its shares times `factor`, so its keys V_{p,i},
+ * valid for every round, gain the factor `factor^(2^(T + 1 - j))` of the current round j.
  *
- * @param[out] out The array of output values.
- * @param[in] n The number of random values to generate.
+ * @param[in] player The player whose secret shares have been refreshed.
+ * @param[in] factor The refresh factor.
  */
-static inline __attribute__((always_inline)) mpz_t *player_get_random_product_congruent_one(context_t *ctx, public_key_t *pk)
+static inline __attribute__((always_inline)) void player_multiplicative_compute_new_verification_keys(context_t *ctx, public_key_t *pk, player_t *player, mpz_t factor)
 {
-    mpz_t *out = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
-    check_null_pointer(out);
+    mpz_t power, key;
+    mpz_init_set(power, factor);
+    mpz_init(key);
 
-    mpz_t tmp;
-    mpz_inits(tmp, NULL);
+    mpz_double_pow(power, ctx->T, player->sk.j, pk->N);
 
-    mpz_set_ui(tmp, 1);
-
-    for (int i = 0; i < ctx->n - 1; i++)
+    for (uint32_t i = 0; i < ctx->l; i++)
     {
-        mpz_init(out[i]);
-        mpz_urandomm(out[i], ctx->prng, pk->N);
-        mpz_mul(tmp, tmp, out[i]);
-        mpz_mod(tmp, tmp, pk->N);
-    }
-
-    mpz_init(out[ctx->n - 1]);
+        mpz_ptr V = pk->V[player->id * ctx->l + i];
 
-    uint32_t res = mpz_invert(out[ctx->n - 1], tmp, pk->N);
-
-    assert(res != 0);
-
-    mpz_clears(tmp, NULL);
+        mpz_mul(key, V, power);
+        mpz_mod(key, key, pk->N);
+        arena_copy_out(V, key);
+    }
 
-    return out;
+    mpz_clears(power, key, NULL);
 }
 
 /**
- * @brief Computes new secret shares for the player.
+ * @brief Draws the player's own secret shares and computes its partial public components.
  *
- * Computes a new secret share for each player's secret value by multiplying with the given shares.
+ * Used by the distributed key generation of the multiplicative scheme: the partial of component
+ * i is S_i^(2^(T + 1)), so the public component is the product of the partials of all the players.
  *
- * @param[in, out] S The player's current secret parameters.
- * @param[in] shares The shares from other players.
+ * @param[in, out] player The player whose secret shares are drawn.
+ * @param[out] partials The l partial public components.
+ * @param[in] prng The random state of the player.
  */
-static inline __attribute__((always_inline)) void player_multiplicative_compute_new_secret_share(context_t *ctx, public_key_t *pk, player_t *players, mpz_t **players_random_shares, uint32_t player_idx)
+static inline __attribute__((always_inline)) void player_multiplicative_compute_partials(context_t *ctx, public_key_t *pk, player_t *player, mpz_t *partials, gmp_randstate_t prng)
 {
-    mpz_t *shares = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
-    check_null_pointer(shares);
-
-    for (uint32_t i = 0; i < ctx->n; i++)
+    for (uint32_t i = 0; i < ctx->l; i++)
     {
-        mpz_init_set(shares[i], players_random_shares[i][player_idx]);
+        mpz_set_random_n_coprime(player->sk.S[i], pk->N, prng);
+        mpz_set(partials[i], player->sk.S[i]);
     }
 
-    mpz_t factor;
-    mpz_init(factor);
+    // the l chains are independent: square them side by side
+    mpz_double_pow_batch(partials, ctx->l, ctx->T, 0, pk->N);
+}
 
-    mpz_mmul_array(factor, shares, ctx->n, pk->N);
+/**
+ * @brief Multiplies every secret share of a player by a refresh factor.
+ *
+ * The factor is the product of the random values the player received in the refresh round.
+ *
+ * @param[in, out] player The player whose secret shares are refreshed.
+ * @param[in] factor The refresh factor.
+ */
+static inline __attribute__((always_inline)) void player_multiplicative_compute_new_secret_share(context_t *ctx, public_key_t *pk, player_t *player, mpz_t factor)
+{
+    mpz_t share;
+    mpz_init(share);
 
     for (uint32_t i = 0; i < ctx->l; i++)
     {
-        mpz_mul(players[player_idx].sk.S[i], players[player_idx].sk.S[i], factor);
-        mpz_mod(players[player_idx].sk.S[i], players[player_idx].sk.S[i], pk->N);
-    }
-
-    for (uint32_t i = 0; i < ctx->n; i++)
-    {
-        mpz_clear(shares[i]);
+        mpz_mul(share, player->sk.S[i], factor);
+        mpz_mod(share, share, pk->N);
+        arena_copy_out(player->sk.S[i], share);
     }
 
-    free(shares);
-    mpz_clear(factor);
+    mpz_clear(share);
 }
 
 static inline __attribute__((always_inline)) mpz_point_t *players_polynomial_compute_r_shares(context_t *ctx, public_key_t *pk)
@@ -156,11 +155,10 @@ static inline __attribute__((always_inline)) void players_polynomial_compute_y(c
         mpz_init_set(y_shares[i].y, r_shares[i].y);
     }
 
-    uint32_t exponent = pow(2, ctx->T + 1 - j);
-
-    for (uint32_t i = 1; i < exponent; i++)
+    // r^(2^(T + 1 - j)) as a chain of squarings
+    for (uint32_t i = 0; i < ctx->T + 1 - j; i++)
     {
-        mult_shamir_ss(y_shares, y_shares, r_shares, ctx->n, ctx->threshold, ctx->prng, pk->N);
+        mult_shamir_ss(y_shares, y_shares, y_shares, ctx->n, ctx->threshold, ctx->prng, pk->N);
     }
 
     mpz_t point;
@@ -293,4 +291,66 @@ static inline __attribute__((always_inline)) uint8_t *player_compute_c(context_t
     free(digests);
 
     return c;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Computes the digests arrays of a batch of messages signed in the same round.
+ *
+ * Produces the same digests as `player_compute_c` for each pair (`Y[k]`, `msgs[k]`), reusing
+ * one message buffer for the whole batch.
+ *
+ * @param[out] c The `count * l` digests, the ones of message k start at `c + k * l`.
+ * @param[in] Y The values y of the signatures.
+ * @param[in] j The round number.
+ * @param[in] msgs The messages.
+ * @param[in] count The number of messages.
+ */
+static inline void players_compute_c_batch(context_t *ctx, uint8_t *c, const mpz_t *Y, const uint32_t j, const char **msgs, uint32_t count)
+{
+    char round_str[8];
+    struct hash_context hash;
+
+    snprintf(round_str, sizeof(round_str), "%hhu", j);
+
+    size_t round_len = strlen(round_str);
+    size_t capacity = 0;
+    char *message = NULL;
+
+    uint8_t *digests = (uint8_t *)malloc(ctx->l / 8);
+    check_null_pointer(digests);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        // room for the decimal digits of y, a possible sign and the terminator
+        size_t needed = round_len + mpz_sizeinbase(Y[k], 10) + 2 + strlen(msgs[k]);
+
+        if (needed > capacity)
+        {
+            capacity = 2 * needed;
+            message = (char *)realloc(message, capacity);
+            check_null_pointer(message);
+        }
+
+        memcpy(message, round_str, round_len);
+        mpz_get_str(message + round_len, 10, Y[k]);
+        strcat(message + round_len, msgs[k]);
+
+        hash_function_init(&hash);
+        hash_function_update(&hash, (uint32_t)strlen(message), (const uint8_t *)message);
+        hash_function_digest(&hash, ctx->l / 8, digests);
+
+        // as in `player_compute_c`, the bits past the last whole digest byte stay zero
+        memset(c + k * ctx->l, 0, ctx->l);
+
+        for (uint32_t i = 0; i < ctx->l / 8; i++)
+        {
+            for (uint32_t b = 0; b < 8; b++)
+            {
+                c[k * ctx->l + i * 8 + b] = (digests[i] >> (7 - b)) & 1;
+            }
+        }
+    }
+
+    free(message);
+    free(digests);
+}
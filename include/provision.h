@@ -0,0 +1,58 @@
+#ifndef PROVISION_H
+#define PROVISION_H
+
+#include "context.h"
+
+// bytes of the seed handed to each seeded player
+#define PROVISION_SEED_BYTES 32
+
+/**
+ * @brief The dealer output of `keygen_seeded`.
+ *
+ * Players 0, ..., seeded - 1 receive only a seed and expand their l shares from it with the
+ * ChaCha backend of random.h; the other players receive their l shares explicitly, computed
+ * by the dealer so that all the shares are consistent with the secrets.
+ */
+typedef struct
+{
+    uint32_t n;
+    uint32_t l;
+    uint32_t seeded;
+
+    uint8_t *seeds;           // seeded x PROVISION_SEED_BYTES
+    key_store_t *corrections; // (n - seeded) x l explicit shares, NULL if every player is seeded
+} provision_t;
+
+/**
+ * @brief Draws the seeds of the first `seeded` players from the context random state.
+ *
+ * The store of the explicit shares is allocated for the other players, at zero.
+ */
+provision_t *provision_new(context_t *ctx, uint32_t seeded, const mpz_t N);
+
+/**
+ * @brief Wipes and frees the dealer output.
+ */
+void provision_free(provision_t *provision);
+
+/**
+ * @brief Expands the l shares of the seeded player `id`, uniform modulo `N`.
+ *
+ * @param[out] dst The l initialized values to set, key store views included.
+ */
+void provision_expand(const provision_t *provision, uint32_t id, mpz_t *dst, const mpz_t N);
+
+/**
+ * @brief Returns the bytes handed out by the dealer: the seeds and the explicit shares.
+ */
+size_t provision_size(const provision_t *provision, const mpz_t N);
+
+/**
+ * @brief Returns the bytes handed out by a dealer sending every share explicitly.
+ */
+static inline size_t provision_plain_size(uint32_t n, uint32_t l, const mpz_t N)
+{
+    return (size_t)n * l * mpz_size(N) * sizeof(mp_limb_t);
+}
+
+#endif // PROVISION_H
@@ -0,0 +1,74 @@
+#ifndef QUORUM_H
+#define QUORUM_H
+
+#include <gmp.h>
+#include <stdint.h>
+#include <string.h>
+
+// largest player id + 1 a quorum can hold
+#define QUORUM_MAX_PLAYERS 512
+#define QUORUM_WORDS (QUORUM_MAX_PLAYERS / 64)
+
+// quorums whose Lagrange coefficients are kept by each thread
+#define QUORUM_CACHE_SIZE 16
+
+/**
+ * @brief A set of participating players, as a bitmask of their ids.
+ */
+typedef struct
+{
+    uint64_t bits[QUORUM_WORDS];
+} quorum_t;
+
+/**
+ * @brief Sets `q` to the players whose ids are the bits of `mask` (ids below 64).
+ */
+static inline void quorum_init_mask(quorum_t *q, uint64_t mask)
+{
+    memset(q, 0, sizeof(quorum_t));
+    q->bits[0] = mask;
+}
+
+static inline void quorum_add(quorum_t *q, uint32_t id)
+{
+    q->bits[id / 64] |= (uint64_t)1 << (id % 64);
+}
+
+static inline uint8_t quorum_has(const quorum_t *q, uint32_t id)
+{
+    return (q->bits[id / 64] >> (id % 64)) & 1;
+}
+
+static inline uint32_t quorum_size(const quorum_t *q)
+{
+    uint32_t size = 0;
+
+    for (uint32_t i = 0; i < QUORUM_WORDS; i++)
+    {
+        size += __builtin_popcountll(q->bits[i]);
+    }
+
+    return size;
+}
+
+/**
+ * @brief Writes the ids of the quorum in increasing order to `ids` and returns how many they are.
+ */
+uint32_t quorum_ids(const quorum_t *q, uint32_t *ids);
+
+/**
+ * @brief Returns the Lagrange coefficients at zero for the abscissas id + 1 of the quorum.
+ *
+ * The coefficients are in the order of `quorum_ids`. They are memoized in a per-thread LRU
+ * cache of `QUORUM_CACHE_SIZE` quorums, keyed by the quorum and the modulus, so a repeated
+ * quorum costs a lookup. The returned array belongs to the cache: it stays valid on the
+ * calling thread until `QUORUM_CACHE_SIZE` other quorums have been looked up.
+ */
+const mpz_t *quorum_lagrange_at_zero(const quorum_t *q, const mpz_t N);
+
+/**
+ * @brief Empties the cache of the calling thread.
+ */
+void quorum_cache_clear();
+
+#endif // QUORUM_H
@@ -0,0 +1,59 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <gmp.h>
+#include <stdint.h>
+
+#include <nettle/chacha.h>
+
+#define RANDOM_CHACHA_BUFFER (16 * CHACHA_BLOCK_SIZE)
+
+// extra bits drawn for each value reduced modulo N, the bias left is below 2^-RANDOM_WIDE_BITS
+#define RANDOM_WIDE_BITS 128
+
+typedef enum
+{
+    RANDOM_BACKEND_MT,
+    RANDOM_BACKEND_CHACHA
+} random_backend_t;
+
+#define RANDOM_BACKEND_DEFAULT RANDOM_BACKEND_CHACHA
+
+/**
+ * @brief Initializes a random state with the given backend.
+ *
+ * `RANDOM_BACKEND_MT` is GMP's Mersenne Twister (`gmp_randinit_default`). `RANDOM_BACKEND_CHACHA`
+ * is the ChaCha20 keystream of nettle, keyed with the SHA3-256 digest of the seed and buffered
+ * `RANDOM_CHACHA_BUFFER` bytes at a time. Both are plain `gmp_randstate_t`, so they are seeded
+ * with `gmp_randseed` (or `gmp_randseed_os_rng`), copied with `gmp_randinit_set`, released
+ * with `gmp_randclear` and accepted by every GMP random function.
+ *
+ * @param[out] state The random state to initialize.
+ * @param[in] backend The generator behind the state.
+ */
+void random_init(gmp_randstate_t state, random_backend_t backend);
+
+/**
+ * @brief Returns the backend of a random state initialized with `random_init`.
+ */
+random_backend_t random_backend(gmp_randstate_t state);
+
+/**
+ * @brief Returns a printable name for a backend.
+ */
+const char *random_backend_name(random_backend_t backend);
+
+/**
+ * @brief Sets `count` random numbers modulo `N`.
+ *
+ * The random bits for all the values are drawn with a single request to the generator, then
+ * each value is reduced from `RANDOM_WIDE_BITS` bits more than `N`, so no draw is rejected.
+ *
+ * @param[out] dst The initialized numbers to set.
+ * @param[in] count The number of values.
+ * @param[in] state The random state.
+ * @param[in] N The modulus.
+ */
+void mpz_urandomm_array(mpz_t *dst, uint32_t count, gmp_randstate_t state, const mpz_t N);
+
+#endif // RANDOM_H
@@ -0,0 +1,81 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include "scheme.h"
+#include "transport.h"
+
+/**
+ * @brief Communication cost of the last protocol step run by a runtime.
+ */
+typedef struct
+{
+    uint64_t bytes;
+    uint64_t messages;
+    uint32_t rounds;
+} runtime_stats_t;
+
+/**
+ * @brief Runs the protocol with every player in its own thread.
+ *
+ * During a protocol step each player only sees its own `player_t`, a private copy of the
+ * context with its own random state and the public key; everything else goes through the
+ * transport as serialized protocol messages. The keys are still dealt by `keygen`.
+ */
+typedef struct
+{
+    context_t *ctx;
+    public_key_t *pk;
+    player_t *players;
+    transport_t *transport;
+
+    // public degree reduction coefficients for the abscissas 1..n
+    mpz_t *lambda;
+
+    runtime_stats_t stats;
+} runtime_t;
+
+/**
+ * @brief Creates a runtime over already dealt players.
+ *
+ * @param[in] kind The transport used between the players.
+ * @return Pointer to the new runtime.
+ */
+runtime_t *runtime_new(context_t *ctx, public_key_t *pk, player_t *players, transport_kind_t kind);
+
+/**
+ * @brief Frees the runtime and its transport, the players are left untouched.
+ */
+void runtime_free(runtime_t *rt);
+
+/**
+ * @brief Runs the signing protocol between the players.
+ *
+ * @param[in] m The message to be signed.
+ * @param[in] j The round number for signing.
+ * @return Pointer to the generated signature.
+ */
+signature_t *runtime_sign(runtime_t *rt, const char *m, uint32_t j);
+
+/**
+ * @brief Runs the keys update protocol between the players.
+ *
+ * @param[in] j The current round number.
+ * @return 1 if update was successful, 0 if the final round has been reached.
+ */
+uint8_t runtime_update(runtime_t *rt, uint32_t j);
+
+#ifndef USE_POLYNOMIAL
+
+/**
+ * @brief Runs the refresh protocol of the secret shares between the players.
+ */
+void runtime_refresh(runtime_t *rt);
+
+#endif
+
+/**
+ * @brief Prints the communication cost of the last protocol step.
+ */
+void printf_runtime_stats(const char *name, const runtime_t *rt);
+
+#endif // RUNTIME_H
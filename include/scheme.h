@@ -4,12 +4,37 @@
 #include "dealer.h"
 #include "player.h"
 #include "signature.h"
+#include "quorum.h"
+#include "beaver.h"
+#include "packed.h"
+#include "provision.h"
 #include <math.h>
 
+#define SIGN_BATCH_WINDOW 4
+#define SIGN_BATCH_WINDOW_COUNT 8
+#define SIGN_BATCH_WIDE_WINDOW 8
+#define SIGN_BATCH_WIDE_WINDOW_COUNT 256
+
+// smallest l for which verify_parallel splits the subset product
+#define VERIFY_PARALLEL_SPLIT_MIN_L 128
+
 /**
  * @brief Simulate the protocol for key generation for all players in the system.
  */
 void keygen(context_t *ctx, public_key_t *pk, player_t *players);
+/**
+ * @brief Simulate the protocol for key generation with seed-compressed provisioning.
+ *
+ * Instead of l shares, a player can receive a short seed and expand its shares with
+ * `provision_expand`. In the multiplicative scheme every player is seeded, since any shares
+ * make a valid key. In the polynomial scheme the first t players are seeded: their shares fix
+ * the polynomials, hence the secrets, and the dealer sends the other n - t players their
+ * shares explicitly. The keys are the same as the ones of `keygen`.
+ *
+ * @return The dealer output, to be released with `provision_free`.
+ */
+provision_t *keygen_seeded(context_t *ctx, public_key_t *pk, player_t *players);
+
 /**
  * @brief Simulate the protocol for signing a message using the given round number.
  *
@@ -19,6 +44,36 @@ void keygen(context_t *ctx, public_key_t *pk, player_t *players);
  */
 signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j);
 
+/**
+ * @brief Simulate the protocol for signing a batch of messages in the same round.
+ *
+ * The nonces of all the messages run their squaring chains together and the digests are
+ * computed in bulk. The signatures are initialized in `out` and must be released with
+ * `signature_clear`.
+ *
+ * @param[in] msgs The messages to be signed.
+ * @param[in] count The number of messages.
+ * @param[in] j The round number for signing.
+ * @param[out] out The buffer of `count` signatures.
+ */
+void sign_batch(context_t *ctx, public_key_t *pk, player_t *players, const char **msgs, uint32_t count, uint32_t j, signature_t *out);
+
+/**
+ * @brief Simulate the protocol for signing a message with only the players of a quorum.
+ *
+ * In the polynomial scheme the other players neither compute nor receive anything, so a slow
+ * or offline player does not stall the signature; the Lagrange coefficients of the quorum are
+ * memoized, see `quorum_lagrange_at_zero`. Every secure multiplication needs 2t - 1 shares,
+ * which is the smallest usable quorum. In the multiplicative scheme the key is shared n-of-n
+ * and only the full quorum is accepted.
+ *
+ * @param[in] quorum The ids of the participating players.
+ * @param[in] m The message to be signed.
+ * @param[in] j The round number for signing.
+ * @return Pointer to the generated signature, NULL if the quorum cannot sign.
+ */
+signature_t *sign_quorum(context_t *ctx, public_key_t *pk, player_t *players, const quorum_t *quorum, const char *m, uint32_t j);
+
 /**
  * @brief Simulatet the protocol for players' keys update for the given round.
  *
@@ -27,12 +82,125 @@ signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const cha
  */
 uint8_t update(context_t *ctx, public_key_t *pk, player_t *players, uint32_t j);
 
+/**
+ * @brief Simulate the protocol for players' keys update straight to the given round.
+ *
+ * Equivalent to calling `update` once for every round between the current one and
+ * `target_period`, but each secret runs its whole squaring chain in one go and the secrets
+ * are processed in parallel.
+ *
+ * @param[in] target_period The round the keys are moved to.
+ * @return 1 if update was successful, 0 if `target_period` is past the final round or
+ * behind the current one.
+ */
+uint8_t update_to(context_t *ctx, public_key_t *pk, player_t *players, uint32_t target_period);
+
+#ifdef USE_POLYNOMIAL
+
+/**
+ * @brief Simulate the protocol for signing a message with preprocessed multiplication triples.
+ *
+ * Same as `sign`, but every squaring of the nonce chain and every product by a key share
+ * consumes a triple of `pool` instead of a resharing round: the only work left while the
+ * message waits is the dealing of r, two openings per multiplication and local combinations.
+ *
+ * @param[in] pool The triples, generated for the same key and parameters.
+ * @param[in] m The message to be signed.
+ * @param[in] j The round number for signing.
+ * @return Pointer to the generated signature
+ */
+signature_t *sign_beaver(context_t *ctx, public_key_t *pk, player_t *players, beaver_pool_t *pool, const char *m, uint32_t j);
+
+/**
+ * @brief Simulate the protocol for key generation with `factor` key components per share.
+ *
+ * The components are dealt in packs of `factor` with `packed_share`, so every player stores
+ * ceil(l / factor) shares instead of l. The keys must then be used with `sign_packed` and
+ * `update_packed`; the public key is the same as the one of `keygen`.
+ *
+ * @param[in] factor The packing factor, see `packed_fits`.
+ * @return 1 on success, 0 (nothing initialized) if `factor` does not fit n and the threshold.
+ */
+uint8_t keygen_packed(context_t *ctx, public_key_t *pk, player_t *players, uint32_t factor);
+
+/**
+ * @brief Simulate the protocol for signing a message with packed keys, see `keygen_packed`.
+ *
+ * Every selected key component is first unpacked into a plain sharing with one resharing, see
+ * `packed_unpack`, and then multiplied as in `sign`; no pack is ever opened. With keys of
+ * `keygen` it is `sign`.
+ *
+ * @param[in] m The message to be signed.
+ * @param[in] j The round number for signing.
+ * @return Pointer to the generated signature
+ */
+signature_t *sign_packed(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j);
+
+/**
+ * @brief Simulate the protocol for packed keys update for the given round, see `keygen_packed`.
+ *
+ * The squarings of the components of a pack share one resharing round, so a period transition
+ * takes ceil(l / factor) resharings instead of l. With keys of `keygen` it is `update`.
+ *
+ * @param[in] j The current round number.
+ * @return 1 if update was successful, 0 if the final round has been reached.
+ */
+uint8_t update_packed(context_t *ctx, public_key_t *pk, player_t *players, uint32_t j);
+
+#endif
+
 #ifndef USE_POLYNOMIAL
 
+/**
+ * @brief Simulate the protocol for key generation without a dealer for the shares.
+ *
+ * Every player draws its own shares and publishes its partial public components
+ * S_i^(2^(T + 1)), see `player_multiplicative_compute_partials`; the players run in parallel
+ * on the worker pool, as they would on their own hardware. The combine step multiplies the
+ * partials into the public key, split by component among the threads. The modulus is still
+ * generated as in `keygen`.
+ */
+void keygen_distributed(context_t *ctx, public_key_t *pk, player_t *players);
+
+/**
+ * @brief Checks the contributions of the players to a signature with their verification keys.
+ *
+ * The contribution (y_p, z_p) of player p is valid if z_p^(2^(T + 1 - j)) = y_p * prod(V_{p,i}^c_i).
+ * The chains of the n z_p run side by side in the SIMD lanes and the subset products are split
+ * among the threads of the worker pool.
+ *
+ * @param[in] c The digests of the round.
+ * @param[in] j The round number.
+ * @param[in] y_players The y contributions of the players.
+ * @param[in] z_players The z contributions of the players.
+ * @param[out] valid The n flags set to 1 for the valid contributions, 0 for the others.
+ * @return The number of valid contributions.
+ */
+uint32_t verify_partials(context_t *ctx, public_key_t *pk, const uint8_t *c, uint32_t j, mpz_t *y_players, mpz_t *z_players, uint8_t *valid);
+
+/**
+ * @brief Simulate the protocol for signing a message, identifying the faulty players.
+ *
+ * Same as `sign` while every contribution is correct, plus a `verify` of the result. When it
+ * fails, `verify_partials` tells which players contributed a bad z; they compute it once more
+ * from the same r and only if some of them are still faulty the round is given up.
+ *
+ * @param[in] m The message to be signed.
+ * @param[in] j The round number for signing.
+ * @param[out] faulty The n flags set to 1 for the players whose contribution was invalid.
+ * @return Pointer to the generated signature, NULL if some player is still faulty.
+ */
+signature_t *sign_checked(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j, uint8_t *faulty);
+
 /**
  * @brief Simulate the protocol for refreshes of the secret shares of all players.
+ *
+ * The per-player verification keys of the public key are kept current.
+ *
+ * @return 1 if the shares have been refreshed, 0 if a drawn value is not invertible modulo N,
+ * in which case the shares are left untouched.
  */
-void refresh(context_t *ctx, public_key_t *pk, player_t *players);
+uint8_t refresh(context_t *ctx, public_key_t *pk, player_t *players);
 
 #endif
 
@@ -47,4 +215,17 @@ void cleanup(context_t *ctx, public_key_t *pk, player_t *players);
  */
 uint8_t verify(context_t *ctx, public_key_t *pk, const char *m, const signature_t *s);
 
+/**
+ * @brief Verifies a signature with lower latency, see `verify`.
+ *
+ * Once the challenge is known the squaring chain of z and the subset product of the public key
+ * components are run at the same time on the worker pool. From `VERIFY_PARALLEL_SPLIT_MIN_L`
+ * components on, the subset product is also split among the remaining threads.
+ *
+ * @param[in] m The message to verify.
+ * @param[in] s The signature to verify.
+ * @return 1 if the signature is valid, 0 otherwise.
+ */
+uint8_t verify_parallel(context_t *ctx, public_key_t *pk, const char *m, const signature_t *s);
+
 #endif // SCHEME_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "scheme.h"
+
+/**
+ * @brief A signing session over a shared key.
+ *
+ * The protocol parameters, the public key and the players' shares are shared by all the
+ * sessions and only read while signing; the session owns a copy of the parameters with its
+ * own random state, the only thing the protocol writes to. Sessions used by different
+ * threads can therefore sign with the same key at the same time, without locking.
+ *
+ * Key evolution (`update`, `update_to`, `refresh`) changes the shared shares and must not run
+ * while a session is signing; `evolver_t` moves to the next period without stopping the signers.
+ */
+typedef struct
+{
+    context_t ctx;
+    public_key_t *pk;
+    player_t *players;
+} session_t;
+
+/**
+ * @brief Opens a session on a dealt key.
+ *
+ * The random state of the session is seeded from the operating system, so sessions can be
+ * opened concurrently and `ctx` is only read.
+ *
+ * @param[in] ctx The protocol parameters of the key.
+ * @param[in] pk The public key.
+ * @param[in] players The players holding the shares of the key.
+ * @return Pointer to the new session.
+ */
+session_t *session_new(const context_t *ctx, public_key_t *pk, player_t *players);
+
+/**
+ * @brief Closes the session, the key is left untouched.
+ */
+void session_free(session_t *session);
+
+/**
+ * @brief Signs a message within the session, see `sign`.
+ */
+signature_t *session_sign(session_t *session, const char *m, uint32_t j);
+
+/**
+ * @brief Signs a batch of messages within the session, see `sign_batch`.
+ */
+void session_sign_batch(session_t *session, const char **msgs, uint32_t count, uint32_t j, signature_t *out);
+
+/**
+ * @brief Verifies a signature within the session, see `verify`.
+ */
+uint8_t session_verify(session_t *session, const char *m, const signature_t *s);
+
+#endif // SESSION_H
@@ -18,3 +18,10 @@ signature_t *signature_malloc(mpz_t y, mpz_t z, uint8_t j);
  * @param[in] s Pointer to the `signature_t` structure to be freed.
  */
 void signature_free(signature_t *s);
+
+/**
+ * @brief Clears a signature stored in a caller-provided buffer, without freeing it.
+ *
+ * @param[in] s Pointer to the `signature_t` structure to be cleared.
+ */
+void signature_clear(signature_t *s);
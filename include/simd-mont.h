@@ -0,0 +1,71 @@
+#ifndef SIMD_MONT_H
+#define SIMD_MONT_H
+
+#include <gmp.h>
+#include <stdint.h>
+
+// largest modulus handled by the kernels
+#define SIMD_MONT_MAX_BITS 4096
+
+// digits of 52 bits (IFMA) or 26 bits (AVX2) for a SIMD_MONT_MAX_BITS modulus, with 2 bits of headroom
+#define SIMD_MONT_MAX_DIGITS ((SIMD_MONT_MAX_BITS + 2 + 25) / 26)
+
+#define SIMD_MONT_MAX_LANES 8
+
+typedef enum
+{
+    SIMD_MONT_NONE,
+    SIMD_MONT_AVX2,
+    SIMD_MONT_AVX512_IFMA
+} simd_mont_isa_t;
+
+/**
+ * @brief Returns the instruction set used by `simd_mont_square_batch`.
+ *
+ * It is `simd_mont_best_isa`, detected on first use, unless it has been changed with
+ * `simd_mont_set_isa`.
+ */
+simd_mont_isa_t simd_mont_isa();
+
+/**
+ * @brief Selects the instruction set used by `simd_mont_square_batch`.
+ *
+ * Meant for tests and benchmarks, any instruction set supported by the CPU can be selected; the
+ * others fall back to `SIMD_MONT_NONE`. Must not be called while another thread is squaring.
+ *
+ * @return The instruction set actually selected.
+ */
+simd_mont_isa_t simd_mont_set_isa(simd_mont_isa_t isa);
+
+/**
+ * @brief Returns the best instruction set for the CPU.
+ *
+ * AVX-512 IFMA when supported. AVX2 only on CPUs without ADX: with it GMP's single chain
+ * already outruns four lanes of 26 bit digits, so `SIMD_MONT_NONE` is returned.
+ */
+simd_mont_isa_t simd_mont_best_isa();
+
+/**
+ * @brief Returns the number of chains run side by side with an instruction set.
+ */
+uint32_t simd_mont_lanes(simd_mont_isa_t isa);
+
+/**
+ * @brief Returns a printable name for an instruction set.
+ */
+const char *simd_mont_isa_name(simd_mont_isa_t isa);
+
+/**
+ * @brief Sets every value to `value^(2^squarings) mod N`, running independent chains in SIMD lanes.
+ *
+ * Each lane holds one value in Montgomery form with radix 2^52 digits multiplied with IFMA
+ * (8 lanes of AVX-512) or radix 2^26 digits multiplied with `vpmuludq` (4 lanes of AVX2). The
+ * reduction is the word-by-word Montgomery one, kept below 2N between squarings (4N < R), so
+ * the lanes run the same instructions whatever their values.
+ *
+ * @return 1 on success, 0 (leaving the values untouched) when no instruction set is available,
+ * N is even or larger than `SIMD_MONT_MAX_BITS` or a value is not in [0, N).
+ */
+uint8_t simd_mont_square_batch(mpz_t *values, uint32_t count, uint32_t squarings, const mpz_t N);
+
+#endif // SIMD_MONT_H
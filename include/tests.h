@@ -4,8 +4,46 @@ void test_simple_sign_verify();
 
 void test_round_update_sign_verify();
 
+void test_update_to_sign_verify();
+
+void test_runtime_sign_verify();
+
+void test_transport_large_messages();
+
+void test_sign_batch_verify();
+
+void test_concurrent_sessions_sign_verify();
+
+void test_random_backends_sign_verify();
+
+void test_fixed_limb_consistency();
+
+void test_simd_mont_consistency();
+
+void test_key_store_layout();
+
+void test_shamir_consistency();
+
+void test_sign_quorum_verify();
+
+void test_beaver_sign_verify();
+
+void test_packed_sign_verify();
+
+void test_seeded_keygen_sign_verify();
+
+void test_verify_parallel_sign_verify();
+
 void test_forge_sign_verify();
 
-#ifndef USE_POLYNOMIAL
+void test_evolver_sign_verify();
+
+#ifdef USE_POLYNOMIAL
+void test_evolver_packed_sign_verify();
+#else
 void test_refresh_sign_verify();
+
+void test_distributed_keygen_sign_verify();
+
+void test_partial_verify_sign_verify();
 #endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+typedef enum
+{
+    TRANSPORT_QUEUE,
+    TRANSPORT_SOCKET,
+    TRANSPORT_SHM
+} transport_kind_t;
+
+typedef struct transport_s transport_t;
+
+/**
+ * @brief Point-to-point channels between `n` parties.
+ *
+ * Every ordered pair of parties has its own FIFO channel, so a receiver always names the
+ * sender it waits for. Messages are opaque byte strings; the counters cover every message
+ * handed to `transport_send`.
+ */
+struct transport_s
+{
+    uint32_t n;
+    transport_kind_t kind;
+
+    void (*send)(transport_t *t, uint32_t from, uint32_t to, const uint8_t *data, size_t len);
+    uint8_t *(*recv)(transport_t *t, uint32_t to, uint32_t from, size_t *len);
+    void (*destroy)(transport_t *t);
+
+    atomic_uint_fast64_t bytes;
+    atomic_uint_fast64_t messages;
+};
+
+/**
+ * @brief Creates the channels between `n` parties.
+ *
+ * `TRANSPORT_QUEUE` keeps the messages in locked in-process queues, `TRANSPORT_SOCKET` writes
+ * them on a Unix stream socket pair for every pair of parties. `TRANSPORT_SHM` streams them
+ * through a lock-free single-producer/single-consumer ring for every ordered pair, placed in
+ * a shared mapping (so it also works between processes forked after its creation) and with
+ * futex wakeups only when one side has to wait. With sockets and rings a party blocked on a full
+ * channel reads ahead its own incoming channels meanwhile, so every party may send all its
+ * messages of a round before receiving, whatever their size.
+ *
+ * @param[in] kind The kind of channels.
+ * @param[in] n The number of parties.
+ * @return Pointer to the new transport.
+ */
+transport_t *transport_new(transport_kind_t kind, uint32_t n);
+
+/**
+ * @brief Sends `len` bytes from party `from` to party `to`, without waiting for the receiver.
+ *
+ * A party sends and receives from a single thread: the data read ahead while a send waits
+ * belongs to the receiving side of the same party.
+ */
+void transport_send(transport_t *t, uint32_t from, uint32_t to, const uint8_t *data, size_t len);
+
+/**
+ * @brief Waits for the next message sent from party `from` to party `to`.
+ *
+ * @param[out] len The length of the message.
+ * @return The message, to be released with `free`.
+ */
+uint8_t *transport_recv(transport_t *t, uint32_t to, uint32_t from, size_t *len);
+
+/**
+ * @brief Returns a printable name for a kind of transport.
+ */
+const char *transport_name(transport_kind_t kind);
+
+/**
+ * @brief Resets the byte and message counters.
+ */
+void transport_reset_counters(transport_t *t);
+
+/**
+ * @brief Closes the channels and frees the transport.
+ */
+void transport_free(transport_t *t);
+
+#endif // TRANSPORT_H
@@ -4,13 +4,21 @@
 #include <gmp.h>
 #include <stdint.h>
 #include <assert.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #include "../lib/lib-mesg.h"
 #include "../lib/lib-misc.h"
 
+#include "alloc-profiler.h"
+#include "arena.h"
+#include "random.h"
+#include "fixed-limb.h"
+#include "simd-mont.h"
+
 #include <nettle/sha3.h>
 
 #define hash_digest_len SHA3_256_DIGEST_SIZE
@@ -21,6 +29,12 @@
 #define hash_function_digest sha3_256_digest
 
 #define PRIME_ITERATIONS 12
+#define PRIME_SIEVE_BOUND (1 << 15)
+#define PRIME_SIEVE_WINDOW 4096
+
+#define PRNG_DERIVED_SEED_BITS 256
+
+#define SIMD_MONT_MIN_BATCH 2
 
 #define BENCH_SAMPLING_TIME 5 /* secondi */
 #define MAX_SAMPLES (BENCH_SAMPLING_TIME * 1000)
@@ -41,12 +55,27 @@ void check_null_pointer(void *ptr);
 /**
  * @brief Sets a random prime number to `dst` with `l` bits, congruent to 3 mod 4.
  *
+ * A random l-bit starting point with the top bit and the 3 mod 4 residue forced is drawn, then
+ * the window of the next `PRIME_SIEVE_WINDOW` candidates congruent to 3 mod 4 is sieved with the
+ * odd primes below `PRIME_SIEVE_BOUND` and only the survivors are tested for primality.
+ *
  * @param[out] dst The generated prime number.
  * @param[in] prng The random state used to generate the prime number.
  * @param[in] l The number of bits for the generated prime number.
  */
 void mpz_set_lbit_prime(mpz_t dst, gmp_randstate_t prng, __uint32_t l);
 
+/**
+ * @brief Initializes a random state seeded from another one.
+ *
+ * Used to give each thread its own state, since a `gmp_randstate_t` cannot be shared. The new
+ * state has the same backend as `parent`.
+ *
+ * @param[out] dst The random state to initialize.
+ * @param[in] parent The random state that provides the seed.
+ */
+void gmp_randinit_derived(gmp_randstate_t dst, gmp_randstate_t parent);
+
 /**
  * @brief Sets a random number to `dst` that is coprime to `n`.
  *
@@ -66,6 +95,32 @@ void mpz_set_random_n_coprime(mpz_t dst, mpz_t n, gmp_randstate_t prng);
  */
 void mpz_double_pow(mpz_t dst, uint32_t T, uint32_t j, mpz_t N);
 
+/**
+ * @brief Computes (`values[i] ^ (2 ^ (T + 1 - j))`) in place for a whole batch of values.
+ *
+ * The exponent is set up once for the batch; every value runs the same chain of squarings.
+ *
+ * @param[in, out] values The values to exponentiate.
+ * @param[in] count The number of values.
+ * @param[in] T The total number of iterations.
+ * @param[in] j The current iteration index.
+ * @param[in] N The modulus used for exponentiation.
+ */
+void mpz_double_pow_batch(mpz_t *values, uint32_t count, uint32_t T, uint32_t j, mpz_t N);
+
+/**
+ * @brief Computes (`values[i] ^ (2 ^ squarings)`) in place for a batch of independent values.
+ *
+ * From `SIMD_MONT_MIN_BATCH` values on the chains run side by side in the SIMD lanes of
+ * `simd_mont_square_batch`; otherwise, or when no SIMD kernel applies, one at a time.
+ *
+ * @param[in, out] values The values to square, in [0, N).
+ * @param[in] count The number of values.
+ * @param[in] squarings The number of squarings of each value.
+ * @param[in] N The modulus used for exponentiation.
+ */
+void mpz_square_batch(mpz_t *values, uint32_t count, uint32_t squarings, mpz_t N);
+
 /**
  * @brief Computes the right multiplicative share of (`base * prod(key_i^c)`).
  *
@@ -98,6 +153,20 @@ uint8_t *compute_hash_digest(const char *m, uint32_t hash_len);
  */
 void mpz_mmul_array(mpz_t dst, mpz_t *array, uint32_t size, mpz_t N);
 
+/**
+ * @brief Inverts every value of an array modulo `N` with a single modular inversion.
+ *
+ * Uses Montgomery's trick: the prefix products are inverted once and the single inverses are
+ * recovered with three multiplications each. `dst` and `src` must not overlap.
+ *
+ * @param[out] dst The inverses, initialized by the caller.
+ * @param[in] src The values to invert.
+ * @param[in] size The size of the arrays, at least 1.
+ * @param[in] N The modulus used for the computation.
+ * @return 1 on success, 0 if some value is not invertible modulo `N`.
+ */
+uint8_t mpz_batch_invert(mpz_t *dst, mpz_t *src, uint32_t size, mpz_t N);
+
 /**
  * @brief Computes the modular sum of an array of values.
  *
@@ -120,6 +189,15 @@ void mpz_madd_array(mpz_t dst, mpz_t *array, uint32_t size, mpz_t N);
  */
 void shamir_ss(mpz_point_t *out, uint32_t size, mpz_t secret, uint32_t k, gmp_randstate_t prng, mpz_t modulo);
 
+/**
+ * @brief Same as `shamir_ss`, on the abscissas already set in `out`.
+ *
+ * Used when the shares go to a subset of the players, whose abscissas are not 1, ..., size.
+ *
+ * @param[in, out] out The points, initialized by the caller with the abscissas set.
+ */
+void shamir_ss_at(mpz_point_t *out, uint32_t size, mpz_t secret, uint32_t k, gmp_randstate_t prng, mpz_t modulo);
+
 /**
  * @brief Multiplies two sets of Shamir secret shares and generates the resulting shares.
  *
@@ -133,9 +211,49 @@ void shamir_ss(mpz_point_t *out, uint32_t size, mpz_t secret, uint32_t k, gmp_ra
  */
 void mult_shamir_ss(mpz_point_t *dst, mpz_point_t *shares_a, mpz_point_t *shares_b, uint32_t size, uint32_t treshold, gmp_randstate_t prng, mpz_t modulo);
 
+/**
+ * @brief Multiplies `count` pairs of sets of Shamir secret shares in a single resharing round.
+ *
+ * All the sets must be on the same abscissas, so the Lagrange coefficients of the degree
+ * reduction are computed once and the local products are reshared in a single pass.
+ * The results are on the same abscissas and `dst` may alias `shares_a` or `shares_b`.
+ *
+ * Every player reshares its own local product, weighted by its own Lagrange coefficient, so that
+ * the players only add up the shares they receive. The shares are evaluated with one table of
+ * the powers of the abscissas for the whole batch and reduced once, after the sum.
+ *
+ * @param[out] dst The `count` output arrays of points that hold the results.
+ * @param[in] shares_a The `count` first sets of shares.
+ * @param[in] shares_b The `count` second sets of shares.
+ * @param[in] count The number of multiplications.
+ * @param[in] size The number of shares in each set.
+ * @param[in] treshold The threshold for reconstruction.
+ * @param[in] prng The random state used in the computation.
+ * @param[in] modulo The modulus used for computation.
+ */
+void mult_shamir_ss_batch(mpz_point_t **dst, mpz_point_t **shares_a, mpz_point_t **shares_b, uint32_t count, uint32_t size, uint32_t treshold, gmp_randstate_t prng, mpz_t modulo);
+
+/**
+ * @brief Same as `mult_shamir_ss_batch`, with the Lagrange coefficients at zero of the abscissas given.
+ *
+ * @param[in] lambda The coefficients of `lagrange_coefficients_at_zero` for the abscissas of the shares.
+ */
+void mult_shamir_ss_batch_lambda(mpz_point_t **dst, mpz_point_t **shares_a, mpz_point_t **shares_b, uint32_t count, uint32_t size, uint32_t treshold, const mpz_t *lambda, gmp_randstate_t prng, mpz_t modulo);
+
+/**
+ * @brief Same as `mult_shamir_ss_batch`, with every player resharing its local product.
+ *
+ * The textbook resharing, where the players weight the received shares with the Lagrange
+ * coefficients and every step is reduced. Kept as the reference for tests and benchmarks.
+ */
+void mult_shamir_ss_batch_reshare(mpz_point_t **dst, mpz_point_t **shares_a, mpz_point_t **shares_b, uint32_t count, uint32_t size, uint32_t treshold, gmp_randstate_t prng, mpz_t modulo);
+
 /**
  * @brief Additionate two sets of Shamir secret shares and generates the resulting shares.
  *
+ * Every player shares its own secret and adds up the shares it receives, as in
+ * `mult_shamir_ss_batch`: the sum of the secrets is never computed.
+ *
  * @param[out] dst The output array of points that holds the result.
  * @param[in] shares_a The first set of shares.
  * @param[in] shares_b The second set of shares.
@@ -146,6 +264,15 @@ void mult_shamir_ss(mpz_point_t *dst, mpz_point_t *shares_a, mpz_point_t *shares
  */
 void joint_shamir_ss(mpz_point_t *dst, mpz_t *secrets, uint32_t treshold, uint32_t size, gmp_randstate_t prng, mpz_t modulo);
 
+/**
+ * @brief Same as `joint_shamir_ss`, on the abscissas already set in `dst`.
+ *
+ * Used when the secrets come from a subset of the players, whose abscissas are not 1, ..., size.
+ *
+ * @param[in, out] dst The points, initialized by the caller with the abscissas set.
+ */
+void joint_shamir_ss_at(mpz_point_t *dst, mpz_t *secrets, uint32_t treshold, uint32_t size, gmp_randstate_t prng, mpz_t modulo);
+
 /**
  * @brief Performs Lagrange interpolation on the provided shares to reconstruct a value.
  *
@@ -157,6 +284,60 @@ void joint_shamir_ss(mpz_point_t *dst, mpz_t *secrets, uint32_t treshold, uint32
  */
 void lagrange_interpolation(mpz_t result, mpz_point_t *shares, mpz_t point, uint32_t size, mpz_t modulo);
 
+/**
+ * @brief Computes the Lagrange coefficients that interpolate the given shares at `point`.
+ *
+ * The value at `point` is then the sum of `dst[i] * shares[i].y`; only the abscissas of the
+ * shares are used. The O(n^2) products of differences of abscissas stay small and are
+ * reduced lazily, and a single inversion is shared by all the coefficients.
+ *
+ * @param[out] dst The coefficients, initialized by the caller.
+ * @param[in] shares The shares that give the abscissas.
+ * @param[in] point The point at which the coefficients interpolate.
+ * @param[in] size The number of shares.
+ * @param[in] modulo The modulus used in the computation.
+ */
+void lagrange_coefficients_at(mpz_t *dst, mpz_point_t *shares, mpz_t point, uint32_t size, mpz_t modulo);
+
+/**
+ * @brief Computes the Lagrange coefficients that interpolate the given shares at zero.
+ *
+ * The secret is then the sum of `dst[i] * shares[i].y`; only the abscissas of the shares are used.
+ *
+ * @param[out] dst The coefficients, initialized by the caller.
+ * @param[in] shares The shares that give the abscissas.
+ * @param[in] size The number of shares.
+ * @param[in] modulo The modulus used in the computation.
+ */
+void lagrange_coefficients_at_zero(mpz_t *dst, mpz_point_t *shares, uint32_t size, mpz_t modulo);
+
+/**
+ * @brief Computes the coefficients of the Lagrange basis polynomials of the given abscissas.
+ *
+ * The polynomial of degree below `size` through the points is then the one whose coefficient
+ * of x^k is the sum of `dst[j * size + k] * points[j].y`; only the abscissas are used.
+ *
+ * @param[out] dst The `size * size` coefficients, initialized by the caller.
+ * @param[in] points The points that give the abscissas, all distinct.
+ * @param[in] size The number of points.
+ * @param[in] modulo The modulus used in the computation.
+ */
+void lagrange_basis_coefficients(mpz_t *dst, mpz_point_t *points, uint32_t size, mpz_t modulo);
+
+/**
+ * @brief Evaluates the polynomial of `k` coefficients at the abscissas already set in `out`.
+ *
+ * Horner's method with small abscissas: every step only adds a few bits, so the value is
+ * reduced once it outgrows the modulus by a limb instead of at every step.
+ *
+ * @param[in, out] out The points, with the abscissas set and the ordinates initialized.
+ * @param[in] size The number of points.
+ * @param[in] polynomial The coefficients, from the constant term up.
+ * @param[in] k The number of coefficients.
+ * @param[in] modulo The modulus used in the computation.
+ */
+void polynomial_eval_points(mpz_point_t *out, uint32_t size, mpz_t *polynomial, uint32_t k, mpz_t modulo);
+
 /**
  * @brief Utility to clear structure of type mpz_point_t.
  *
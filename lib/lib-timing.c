@@ -380,6 +380,18 @@ static int __et_compare(const void *n1, const void *n2) {
         return 0;
 }
 
+/* estrae un percentile (espresso in %) da un insieme ordinato di rilevamenti
+ * con il metodo nearest-rank */
+static elapsed_time_t __sorted_percentile(const elapsed_time_t vector[],
+                                          size_t size, double percentile) {
+    size_t rank = (size_t)ceil(percentile / 100.0 * size);
+    if (rank < 1)
+        rank = 1;
+    if (rank > size)
+        rank = size;
+    return vector[rank - 1];
+}
+
 /* calcola vari indici statistici sull'insieme di rilevamenti disponibili */
 void extract_stats(stats_t stats, elapsed_time_t vector[], size_t size,
                    enum time_unit unit) {
@@ -393,6 +405,8 @@ void extract_stats(stats_t stats, elapsed_time_t vector[], size_t size,
         stats->unit = unit;
         stats->size = stats->ksize = size;
         stats->min = stats->max = stats->median = stats->mean = vector[0];
+        stats->p50 = stats->p90 = stats->p99 = stats->p999 = stats->p9999 =
+            vector[0];
         stats->stddev = 0.0;
         return;
     }
@@ -426,6 +440,130 @@ void extract_stats(stats_t stats, elapsed_time_t vector[], size_t size,
     }
 
     stats->stddev = sqrt(stats->stddev / stats->ksize);
+
+    /* i percentili sono calcolati sull'intero insieme, senza tagli */
+    stats->p50 = __sorted_percentile(vector, size, 50.0);
+    stats->p90 = __sorted_percentile(vector, size, 90.0);
+    stats->p99 = __sorted_percentile(vector, size, 99.0);
+    stats->p999 = __sorted_percentile(vector, size, 99.9);
+    stats->p9999 = __sorted_percentile(vector, size, 99.99);
+}
+
+/* azzera un istogramma */
+void histogram_init(histogram_t histogram) {
+    assert(histogram);
+    memset(histogram, 0, sizeof(struct histogram_struct));
+    histogram->min = UINT64_MAX;
+}
+
+/* individua l'intervallo dell'istogramma che contiene un rilevamento (ns): i
+ * valori piccoli sono registrati esattamente, quelli grandi con una precisione
+ * relativa costante */
+static inline void __histogram_index(uint64_t value, size_t *bucket,
+                                     size_t *sub_bucket) {
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        *bucket = 0;
+        *sub_bucket = value;
+    } else {
+        size_t msb = 63 - __builtin_clzll(value);
+        *bucket = msb - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+        *sub_bucket = value >> *bucket;
+    }
+}
+
+/* valore (ns) rappresentativo di un intervallo dell'istogramma: il punto medio */
+static inline uint64_t __histogram_value(size_t bucket, size_t sub_bucket) {
+    uint64_t lower = (uint64_t)sub_bucket << bucket;
+    uint64_t upper = lower + ((1ULL << bucket) - 1);
+    return lower + (upper - lower) / 2;
+}
+
+/* registra un rilevamento (ns) nell'istogramma; i valori negativi (dovuti alla
+ * sottrazione dell'overhead) sono registrati come nulli */
+void histogram_record(histogram_t histogram, elapsed_time_t ns) {
+    uint64_t value = (ns > 0.0 ? (uint64_t)rint(ns) : 0);
+    size_t bucket, sub_bucket;
+
+    __histogram_index(value, &bucket, &sub_bucket);
+    histogram->counts[bucket][sub_bucket]++;
+    histogram->total++;
+    if (value < histogram->min)
+        histogram->min = value;
+    if (value > histogram->max)
+        histogram->max = value;
+    histogram->sum += value;
+    histogram->sum_squares += (double)value * value;
+}
+
+/* accumula in un istogramma i rilevamenti di un altro (ad esempio quelli
+ * raccolti da un altro thread) */
+void histogram_merge(histogram_t dst, const histogram_t src) {
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        for (size_t j = 0; j < HISTOGRAM_SUB_BUCKETS; j++)
+            dst->counts[i][j] += src->counts[i][j];
+    dst->total += src->total;
+    if (src->min < dst->min)
+        dst->min = src->min;
+    if (src->max > dst->max)
+        dst->max = src->max;
+    dst->sum += src->sum;
+    dst->sum_squares += src->sum_squares;
+}
+
+/* estrae un percentile (espresso in %) dall'istogramma, in ns */
+elapsed_time_t histogram_percentile(const histogram_t histogram,
+                                    double percentile) {
+    uint64_t rank, count = 0;
+
+    assert(histogram->total > 0);
+
+    rank = (uint64_t)ceil(percentile / 100.0 * histogram->total);
+    if (rank < 1)
+        rank = 1;
+    if (rank > histogram->total)
+        rank = histogram->total;
+
+    for (size_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+        for (size_t j = 0; j < HISTOGRAM_SUB_BUCKETS; j++) {
+            count += histogram->counts[i][j];
+            if (count >= rank) {
+                uint64_t value = __histogram_value(i, j);
+                if (value < histogram->min)
+                    value = histogram->min;
+                if (value > histogram->max)
+                    value = histogram->max;
+                return (elapsed_time_t)value;
+            }
+        }
+
+    return (elapsed_time_t)histogram->max;
+}
+
+/* calcola gli indici statistici a partire da un istogramma: non essendoci i
+ * singoli campioni non vengono applicati i tagli del kernel e la mediana
+ * coincide con il 50-esimo percentile */
+void extract_histogram_stats(stats_t stats, const histogram_t histogram,
+                             enum time_unit unit) {
+    double mean, variance;
+
+    assert(stats);
+    assert(histogram->total >= 1);
+
+    mean = histogram->sum / histogram->total;
+    variance = histogram->sum_squares / histogram->total - mean * mean;
+
+    stats->unit = unit;
+    stats->size = stats->ksize = histogram->total;
+    stats->min = et_to(histogram->min, unit);
+    stats->max = et_to(histogram->max, unit);
+    stats->mean = et_to(mean, unit);
+    stats->stddev = et_to(variance > 0.0 ? sqrt(variance) : 0.0, unit);
+    stats->p50 = et_to(histogram_percentile(histogram, 50.0), unit);
+    stats->p90 = et_to(histogram_percentile(histogram, 90.0), unit);
+    stats->p99 = et_to(histogram_percentile(histogram, 99.0), unit);
+    stats->p999 = et_to(histogram_percentile(histogram, 99.9), unit);
+    stats->p9999 = et_to(histogram_percentile(histogram, 99.99), unit);
+    stats->median = stats->p50;
 }
 
 /* manda su uno stream un singolo valore statistico tenendo conto dell'unità di
@@ -449,6 +587,11 @@ void fprintf_stats(FILE *stream, const char *name, const stats_t stats,
             stats->stddev, time_unit_str[stats->unit]);
     fprintf_et(stream, ", min=", stats->min, stats->unit, "");
     fprintf_et(stream, ", max=", stats->max, stats->unit, "");
+    fprintf_et(stream, ", p50=", stats->p50, stats->unit, "");
+    fprintf_et(stream, ", p90=", stats->p90, stats->unit, "");
+    fprintf_et(stream, ", p99=", stats->p99, stats->unit, "");
+    fprintf_et(stream, ", p99.9=", stats->p999, stats->unit, "");
+    fprintf_et(stream, ", p99.99=", stats->p9999, stats->unit, "");
     fprintf(stream, ", kernel=%zd/%zd%s\n", stats->ksize, stats->size, suffix);
 }
 
@@ -83,10 +83,30 @@ struct stats_struct {
     double mean;
     double median;
     double stddev;
+    double p50, p90, p99, p999, p9999;
 };
 typedef struct stats_struct *stats_ptr;
 typedef struct stats_struct stats_t[1];
 
+/* parametri dell'istogramma a scala logaritmica (in stile HDR): ogni ordine di
+ * grandezza binario è suddiviso in HISTOGRAM_SUB_BUCKETS/2 intervalli lineari,
+ * per un errore relativo massimo di 2/HISTOGRAM_SUB_BUCKETS sui percentili */
+#define HISTOGRAM_SUB_BUCKET_BITS 7
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKETS (64 - HISTOGRAM_SUB_BUCKET_BITS + 1)
+
+/* istogramma dei rilevamenti (in ns) ad occupazione di memoria costante: a
+ * differenza del vettore dei campioni non ha limiti sul numero di rilevazioni
+ * e più istogrammi (ad esempio uno per thread) possono essere fusi */
+struct histogram_struct {
+    uint64_t counts[HISTOGRAM_BUCKETS][HISTOGRAM_SUB_BUCKETS];
+    uint64_t total;
+    uint64_t min, max;
+    double sum, sum_squares;
+};
+typedef struct histogram_struct *histogram_ptr;
+typedef struct histogram_struct histogram_t[1];
+
 /* macro per effettuare un test singolo misurando il wall-clock time tramite i
  * cicli di clock (TSC)
  */
@@ -237,6 +257,59 @@ typedef struct stats_struct stats_t[1];
         free(vector_samples);                                                  \
     }
 
+/* macro per il testing iterato per un periodo prefisatto misurando il tempo di
+ * CPU tramite il metodo di timestamp preselezionato: i rilevamenti vengono
+ * accumulati nell'istogramma indicato (non azzerato) senza limiti sul numero
+ * di campioni */
+#define perform_cpu_time_histogram_sampling_period(STATS, HISTOGRAM, PERIOD,   \
+                                                   UNIT, CODE, CLEAN)          \
+    {                                                                          \
+        assert(STATS != NULL);                                                 \
+        assert(HISTOGRAM != NULL);                                             \
+        assert(PERIOD >= 0);                                                   \
+        timestamp_t ts_before, ts_after;                                       \
+        timestamp_t ts_begin;                                                  \
+        get_timestamp(ts_begin);                                               \
+        for (;;) {                                                             \
+            get_timestamp(ts_before);                                          \
+            {CODE};                                                            \
+            get_timestamp(ts_after);                                           \
+            histogram_record(HISTOGRAM, get_elapsed_time_from_timestamp(       \
+                                            ts_before, ts_after));             \
+            if (et_to(get_elapsed_time_from_timestamp(ts_begin, ts_after),     \
+                      tu_sec) > PERIOD)                                        \
+                break;                                                         \
+            CLEAN                                                              \
+        }                                                                      \
+        extract_histogram_stats(STATS, HISTOGRAM, UNIT);                       \
+    }
+
+/* macro per il testing iterato per un periodo prefisatto misurando il
+ * wall-clock time tramite i cicli di clock (TSC): i rilevamenti vengono
+ * accumulati nell'istogramma indicato (non azzerato) senza limiti sul numero
+ * di campioni */
+#define perform_wc_time_histogram_sampling_period(STATS, HISTOGRAM, PERIOD,    \
+                                                  UNIT, CODE, CLEAN)           \
+    {                                                                          \
+        assert(STATS != NULL);                                                 \
+        assert(HISTOGRAM != NULL);                                             \
+        assert(PERIOD >= 0);                                                   \
+        clock_cycles_t cc_before, cc_after;                                    \
+        clock_cycles_t cc_begin;                                               \
+        cc_begin = get_clock_cycles_before();                                  \
+        for (;;) {                                                             \
+            cc_before = get_clock_cycles_before();                             \
+            {CODE} cc_after = get_clock_cycles_after();                        \
+            histogram_record(HISTOGRAM, get_elapsed_time_from_cpu_cycles(      \
+                                            cc_before, cc_after));             \
+            if (et_to(get_elapsed_time_from_cpu_cycles(cc_begin, cc_after),    \
+                      tu_sec) > PERIOD)                                        \
+                break;                                                         \
+            CLEAN                                                              \
+        }                                                                      \
+        extract_histogram_stats(STATS, HISTOGRAM, UNIT);                       \
+    }
+
 #define printf_et(PREFIX, NUMBER, UNIT, SUFFIX)                                \
     fprintf_et(stdout, PREFIX, NUMBER, UNIT, SUFFIX)
 #define printf_stats(NAME, STATS, SUFFIX)                                      \
@@ -267,6 +340,13 @@ elapsed_time_t get_elapsed_time_from_cpu_cycles(clock_cycles_t before,
 elapsed_time_t et_to(const elapsed_time_t ns, enum time_unit unit);
 void extract_stats(stats_t stats, elapsed_time_t vector[], size_t size,
                    enum time_unit unit);
+void histogram_init(histogram_t histogram);
+void histogram_record(histogram_t histogram, elapsed_time_t ns);
+void histogram_merge(histogram_t dst, const histogram_t src);
+elapsed_time_t histogram_percentile(const histogram_t histogram,
+                                    double percentile);
+void extract_histogram_stats(stats_t stats, const histogram_t histogram,
+                             enum time_unit unit);
 void fprintf_et(FILE *stream, const char *prefix, const elapsed_time_t number,
                 enum time_unit unit, const char *suffix);
 void fprintf_stats(FILE *stream, const char *name, const stats_t stats,
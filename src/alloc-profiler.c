@@ -0,0 +1,143 @@
+#define ALLOC_PROFILER_IMPLEMENTATION
+#include "../include/alloc-profiler.h"
+
+#ifdef USE_ALLOC_PROFILER
+
+#include <gmp.h>
+#include <inttypes.h>
+#include <malloc.h>
+
+static uint64_t allocations, reallocations, frees, bytes;
+static int64_t live, peak, window_live;
+
+static inline void alloc_profiler_account(int64_t delta)
+{
+    int64_t current = __atomic_add_fetch(&live, delta, __ATOMIC_RELAXED);
+    int64_t observed = __atomic_load_n(&peak, __ATOMIC_RELAXED);
+
+    while (current > observed && !__atomic_compare_exchange_n(&peak, &observed, current, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static inline void *alloc_profiler_check(void *ptr)
+{
+    if (ptr == NULL)
+    {
+        fputs("Error while allocating memory.", stderr);
+        exit(-1);
+    }
+
+    return ptr;
+}
+
+void *alloc_profiler_malloc(size_t size)
+{
+    void *ptr = alloc_profiler_check(malloc(size));
+    size_t usable = malloc_usable_size(ptr);
+
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bytes, usable, __ATOMIC_RELAXED);
+    alloc_profiler_account(usable);
+
+    return ptr;
+}
+
+void *alloc_profiler_calloc(size_t count, size_t size)
+{
+    void *ptr = alloc_profiler_check(calloc(count, size));
+    size_t usable = malloc_usable_size(ptr);
+
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bytes, usable, __ATOMIC_RELAXED);
+    alloc_profiler_account(usable);
+
+    return ptr;
+}
+
+void *alloc_profiler_realloc(void *ptr, size_t size)
+{
+    size_t old_usable = malloc_usable_size(ptr);
+
+    ptr = alloc_profiler_check(realloc(ptr, size));
+
+    size_t usable = malloc_usable_size(ptr);
+
+    __atomic_add_fetch(&reallocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bytes, usable, __ATOMIC_RELAXED);
+    alloc_profiler_account((int64_t)usable - (int64_t)old_usable);
+
+    return ptr;
+}
+
+void *alloc_profiler_aligned_alloc(size_t alignment, size_t size)
+{
+    void *ptr = alloc_profiler_check(aligned_alloc(alignment, size));
+    size_t usable = malloc_usable_size(ptr);
+
+    __atomic_add_fetch(&allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&bytes, usable, __ATOMIC_RELAXED);
+    alloc_profiler_account(usable);
+
+    return ptr;
+}
+
+void alloc_profiler_free(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    __atomic_add_fetch(&frees, 1, __ATOMIC_RELAXED);
+    alloc_profiler_account(-(int64_t)malloc_usable_size(ptr));
+
+    free(ptr);
+}
+
+static void *alloc_profiler_gmp_allocate(size_t size)
+{
+    return alloc_profiler_malloc(size);
+}
+
+static void *alloc_profiler_gmp_reallocate(void *ptr, size_t old_size, size_t new_size)
+{
+    return alloc_profiler_realloc(ptr, new_size);
+}
+
+static void alloc_profiler_gmp_free(void *ptr, size_t size)
+{
+    alloc_profiler_free(ptr);
+}
+
+void alloc_profiler_install()
+{
+    mp_set_memory_functions(alloc_profiler_gmp_allocate, alloc_profiler_gmp_reallocate, alloc_profiler_gmp_free);
+}
+
+void alloc_profiler_begin()
+{
+    __atomic_store_n(&allocations, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&reallocations, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&frees, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&bytes, 0, __ATOMIC_RELAXED);
+
+    window_live = __atomic_load_n(&live, __ATOMIC_RELAXED);
+    __atomic_store_n(&peak, window_live, __ATOMIC_RELAXED);
+}
+
+void alloc_profiler_end(alloc_profile_t *profile)
+{
+    profile->allocations = __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+    profile->reallocations = __atomic_load_n(&reallocations, __ATOMIC_RELAXED);
+    profile->frees = __atomic_load_n(&frees, __ATOMIC_RELAXED);
+    profile->bytes = __atomic_load_n(&bytes, __ATOMIC_RELAXED);
+    profile->peak = __atomic_load_n(&peak, __ATOMIC_RELAXED) - window_live;
+    profile->live = __atomic_load_n(&live, __ATOMIC_RELAXED) - window_live;
+}
+
+void fprintf_alloc_profile(FILE *stream, const char *name, const alloc_profile_t *profile)
+{
+    fprintf(stream, "%s: allocs=%" PRIu64 ", reallocs=%" PRIu64 ", frees=%" PRIu64 ", bytes=%" PRIu64 ", peak=%" PRIu64 ", live=%" PRId64 "\n",
+            name, profile->allocations, profile->reallocations, profile->frees,
+            profile->bytes, profile->peak, profile->live);
+}
+
+#endif
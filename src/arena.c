@@ -0,0 +1,356 @@
+#include "../include/arena.h"
+
+#ifdef USE_ARENA
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+    uint8_t *base;
+    size_t size;
+    size_t top;
+} arena_chunk_t;
+
+typedef struct
+{
+    arena_chunk_t *chunks[ARENA_MAX_CHUNKS];
+    void *free_lists[ARENA_SIZE_CLASSES];
+    uint32_t count;
+    uint32_t current;
+    uint32_t depth;
+    uint32_t suspended;
+} arena_t;
+
+/*
+ * Every chunk ever created, by any thread, is registered here so that a block can be
+ * recognized as arena memory whichever thread frees or grows it. Chunks are never released:
+ * when a thread exits its chunks go to the spare list, from which other threads take them.
+ */
+static arena_chunk_t *arena_registry[ARENA_MAX_CHUNKS];
+static uint32_t arena_registry_count;
+static arena_chunk_t *arena_spare[ARENA_MAX_CHUNKS];
+static uint32_t arena_spare_count;
+static pthread_mutex_t arena_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_once_t arena_hooks_once = PTHREAD_ONCE_INIT;
+static pthread_key_t arena_thread_key;
+
+static void *(*arena_next_allocate)(size_t);
+static void *(*arena_next_reallocate)(void *, size_t, size_t);
+static void (*arena_next_free)(void *, size_t);
+
+static __thread arena_t arena;
+
+static inline size_t arena_align(size_t size)
+{
+    return (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+}
+
+static inline size_t arena_size_class(size_t size)
+{
+    return arena_align(size) / ARENA_ALIGNMENT;
+}
+
+static inline int arena_is_active()
+{
+    return arena.depth > 0 && arena.suspended == 0;
+}
+
+static int arena_contains(const void *ptr)
+{
+    uint32_t count = __atomic_load_n(&arena_registry_count, __ATOMIC_ACQUIRE);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if ((const uint8_t *)ptr >= arena_registry[i]->base && (const uint8_t *)ptr < arena_registry[i]->base + arena_registry[i]->size)
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Gives the chunks of an exiting thread to the spare list, wiped.
+ *
+ * Installed as the destructor of `arena_thread_key`, set by a thread when it takes its first chunk.
+ */
+static void arena_thread_exit(void *arg)
+{
+    arena_t *exiting = (arena_t *)arg;
+
+    pthread_mutex_lock(&arena_registry_lock);
+
+    for (uint32_t i = 0; i < exiting->count; i++)
+    {
+        // a thread leaving inside a scope has not wiped its temporaries
+        memset(exiting->chunks[i]->base, 0, exiting->chunks[i]->top);
+        exiting->chunks[i]->top = 0;
+
+        arena_spare[arena_spare_count++] = exiting->chunks[i];
+    }
+
+    pthread_mutex_unlock(&arena_registry_lock);
+
+    memset(exiting, 0, sizeof(arena_t));
+}
+
+static arena_chunk_t *arena_new_chunk(size_t size)
+{
+    arena_chunk_t *chunk = NULL;
+
+    if (arena.count == ARENA_MAX_CHUNKS)
+        return NULL;
+
+    if (arena.count == 0)
+        pthread_setspecific(arena_thread_key, &arena);
+
+    pthread_mutex_lock(&arena_registry_lock);
+
+    for (uint32_t i = 0; i < arena_spare_count; i++)
+    {
+        if (arena_spare[i]->size >= size)
+        {
+            chunk = arena_spare[i];
+            arena_spare[i] = arena_spare[--arena_spare_count];
+
+            arena.chunks[arena.count++] = chunk;
+            break;
+        }
+    }
+
+    if (chunk == NULL && arena_registry_count < ARENA_MAX_CHUNKS)
+    {
+        chunk = (arena_chunk_t *)malloc(sizeof(arena_chunk_t));
+        uint8_t *base = (uint8_t *)aligned_alloc(ARENA_ALIGNMENT, size);
+
+        if (chunk == NULL || base == NULL)
+        {
+            free(chunk);
+            free(base);
+            chunk = NULL;
+        }
+        else
+        {
+            chunk->base = base;
+            chunk->size = size;
+            chunk->top = 0;
+
+            arena_registry[arena_registry_count] = chunk;
+            __atomic_store_n(&arena_registry_count, arena_registry_count + 1, __ATOMIC_RELEASE);
+
+            arena.chunks[arena.count++] = chunk;
+        }
+    }
+
+    pthread_mutex_unlock(&arena_registry_lock);
+
+    return chunk;
+}
+
+/**
+ * @brief Bump-allocates from the thread arena, moving to the next chunk when the current one is full.
+ *
+ * Falls back to the next allocator, with a warning the first time, when all `ARENA_MAX_CHUNKS`
+ * chunks are held by live threads.
+ */
+static void *arena_bump(size_t size)
+{
+    size = arena_align(size);
+
+    while (arena.current < arena.count)
+    {
+        arena_chunk_t *chunk = arena.chunks[arena.current];
+
+        if (chunk->size - chunk->top >= size)
+        {
+            void *ptr = chunk->base + chunk->top;
+            chunk->top += size;
+            return ptr;
+        }
+
+        if (arena.current + 1 == arena.count)
+            break;
+
+        arena.current++;
+    }
+
+    arena_chunk_t *chunk = arena_new_chunk(size > ARENA_CHUNK_SIZE ? size : ARENA_CHUNK_SIZE);
+
+    if (chunk == NULL)
+    {
+        static atomic_flag warned = ATOMIC_FLAG_INIT;
+
+        if (!atomic_flag_test_and_set(&warned))
+            fputs("Arena chunks exhausted, falling back to the system allocator.\n", stderr);
+
+        return arena_next_allocate(size);
+    }
+
+    arena.current = arena.count - 1;
+    chunk->top = size;
+
+    return chunk->base;
+}
+
+/**
+ * @brief Returns true if `ptr` lies in one of the chunks of the calling thread.
+ */
+static int arena_owns(const void *ptr)
+{
+    for (uint32_t i = 0; i < arena.count; i++)
+    {
+        if ((const uint8_t *)ptr >= arena.chunks[i]->base && (const uint8_t *)ptr < arena.chunks[i]->base + arena.chunks[i]->size)
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Returns true if `ptr` is the most recent block of the current chunk of this thread.
+ */
+static inline int arena_is_top(const void *ptr, size_t size)
+{
+    if (arena.current >= arena.count)
+        return 0;
+
+    arena_chunk_t *chunk = arena.chunks[arena.current];
+
+    return (const uint8_t *)ptr + arena_align(size) == chunk->base + chunk->top;
+}
+
+static void *arena_allocate(size_t size)
+{
+    if (!arena_is_active())
+        return arena_next_allocate(size);
+
+    size_t size_class = arena_size_class(size);
+
+    if (size_class < ARENA_SIZE_CLASSES && arena.free_lists[size_class] != NULL)
+    {
+        void *ptr = arena.free_lists[size_class];
+        arena.free_lists[size_class] = *(void **)ptr;
+        return ptr;
+    }
+
+    return arena_bump(size);
+}
+
+/**
+ * @brief Gives a block back to the arena of the calling thread.
+ *
+ * The most recent block just lowers the top of the chunk, small blocks are recycled through
+ * per-size free lists and anything else is only reclaimed when the scope ends.
+ */
+static void arena_release(void *ptr, size_t size)
+{
+    if (!arena_is_active())
+        return;
+
+    if (arena_is_top(ptr, size))
+    {
+        arena.chunks[arena.current]->top = (uint8_t *)ptr - arena.chunks[arena.current]->base;
+        return;
+    }
+
+    size_t size_class = arena_size_class(size);
+
+    if (size_class > 0 && size_class < ARENA_SIZE_CLASSES && arena_owns(ptr))
+    {
+        *(void **)ptr = arena.free_lists[size_class];
+        arena.free_lists[size_class] = ptr;
+    }
+}
+
+static void *arena_reallocate(void *ptr, size_t old_size, size_t new_size)
+{
+    if (!arena_contains(ptr))
+        return arena_next_reallocate(ptr, old_size, new_size);
+
+    void *dst;
+
+    if (arena_is_active())
+    {
+        if (arena_is_top(ptr, old_size))
+        {
+            arena_chunk_t *chunk = arena.chunks[arena.current];
+            size_t offset = (uint8_t *)ptr - chunk->base;
+
+            if (chunk->size - offset >= arena_align(new_size))
+            {
+                chunk->top = offset + arena_align(new_size);
+                return ptr;
+            }
+        }
+
+        dst = arena_allocate(new_size);
+        memcpy(dst, ptr, old_size < new_size ? old_size : new_size);
+        arena_release(ptr, old_size);
+
+        return dst;
+    }
+
+    dst = arena_next_allocate(new_size);
+    memcpy(dst, ptr, old_size < new_size ? old_size : new_size);
+
+    return dst;
+}
+
+static void arena_free(void *ptr, size_t size)
+{
+    if (!arena_contains(ptr))
+    {
+        arena_next_free(ptr, size);
+        return;
+    }
+
+    arena_release(ptr, size);
+}
+
+static void arena_install_hooks()
+{
+    pthread_key_create(&arena_thread_key, arena_thread_exit);
+
+    mp_get_memory_functions(&arena_next_allocate, &arena_next_reallocate, &arena_next_free);
+    mp_set_memory_functions(arena_allocate, arena_reallocate, arena_free);
+}
+
+void arena_scope_begin()
+{
+    pthread_once(&arena_hooks_once, arena_install_hooks);
+
+    arena.depth++;
+}
+
+void arena_scope_end()
+{
+    if (--arena.depth > 0)
+        return;
+
+    // temporaries may hold secrets (nonces, old key shares): wipe them before rewinding
+    for (uint32_t i = 0; i < arena.count; i++)
+    {
+        memset(arena.chunks[i]->base, 0, arena.chunks[i]->top);
+        arena.chunks[i]->top = 0;
+    }
+
+    memset(arena.free_lists, 0, sizeof(arena.free_lists));
+    arena.current = 0;
+}
+
+void arena_scope_suspend()
+{
+    arena.suspended++;
+}
+
+void arena_scope_resume()
+{
+    arena.suspended--;
+}
+
+#endif
@@ -0,0 +1,345 @@
+#include "../include/beaver.h"
+
+#include <time.h>
+
+static mpz_point_t *beaver_points(uint32_t n)
+{
+    mpz_point_t *points = (mpz_point_t *)malloc(n * sizeof(mpz_point_t));
+    check_null_pointer(points);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        mpz_init_set_ui(points[i].x, i + 1);
+        mpz_init(points[i].y);
+    }
+
+    return points;
+}
+
+static void beaver_points_free(mpz_point_t *points, uint32_t n)
+{
+    for (uint32_t i = 0; i < n; i++)
+    {
+        mpz_clear_point(points[i]);
+    }
+
+    free(points);
+}
+
+void beaver_triple_clear(beaver_triple_t *triple, uint32_t n)
+{
+    beaver_points_free(triple->a, n);
+    beaver_points_free(triple->c, n);
+
+    // a square triple shares its a and b
+    if (triple->b != triple->a)
+        beaver_points_free(triple->b, n);
+}
+
+/**
+ * @brief Generates `count` triples of a kind: a and b are joint random sharings and c comes
+ * from one batched degree reduction.
+ */
+static void beaver_generate(beaver_pool_t *pool, beaver_kind_t kind, beaver_triple_t *triples, uint32_t count)
+{
+    mpz_point_t **a = (mpz_point_t **)malloc(count * sizeof(mpz_point_t *));
+    check_null_pointer(a);
+
+    mpz_point_t **b = (mpz_point_t **)malloc(count * sizeof(mpz_point_t *));
+    check_null_pointer(b);
+
+    mpz_point_t **c = (mpz_point_t **)malloc(count * sizeof(mpz_point_t *));
+    check_null_pointer(c);
+
+    mpz_t *secrets = (mpz_t *)malloc(pool->n * sizeof(mpz_t));
+    check_null_pointer(secrets);
+
+    for (uint32_t i = 0; i < pool->n; i++)
+    {
+        mpz_init(secrets[i]);
+    }
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        triples[k].a = a[k] = (mpz_point_t *)malloc(pool->n * sizeof(mpz_point_t));
+        check_null_pointer(a[k]);
+
+        // every player contributes a random value to a, and to b
+        mpz_urandomm_array(secrets, pool->n, pool->prng, pool->N);
+        joint_shamir_ss(a[k], secrets, pool->threshold, pool->n, pool->prng, pool->N);
+
+        if (kind == BEAVER_SQUARE)
+        {
+            b[k] = a[k];
+        }
+        else
+        {
+            b[k] = (mpz_point_t *)malloc(pool->n * sizeof(mpz_point_t));
+            check_null_pointer(b[k]);
+
+            mpz_urandomm_array(secrets, pool->n, pool->prng, pool->N);
+            joint_shamir_ss(b[k], secrets, pool->threshold, pool->n, pool->prng, pool->N);
+        }
+
+        triples[k].b = b[k];
+        triples[k].c = c[k] = beaver_points(pool->n);
+    }
+
+    mult_shamir_ss_batch_lambda(c, a, b, count, pool->n, pool->threshold, (const mpz_t *)pool->lambda, pool->prng, pool->N);
+
+    for (uint32_t i = 0; i < pool->n; i++)
+    {
+        mpz_clear(secrets[i]);
+    }
+
+    free(secrets);
+    free(a);
+    free(b);
+    free(c);
+}
+
+static void *beaver_producer(void *arg)
+{
+    beaver_pool_t *pool = (beaver_pool_t *)arg;
+    beaver_triple_t batch[BEAVER_BATCH];
+    struct timespec before, after;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (;;)
+    {
+        uint32_t squares = pool->rings[BEAVER_SQUARE].count, products = pool->rings[BEAVER_PRODUCT].count;
+
+        // once both rings are full the producer sleeps until one of them is half empty, so that
+        // it does not compete with the signers for every triple they take
+        if (squares == pool->capacity && products == pool->capacity)
+        {
+            pool->refill = 0;
+
+            while (!pool->stop && !pool->refill && pool->rings[BEAVER_SQUARE].count > pool->capacity / 2 && pool->rings[BEAVER_PRODUCT].count > pool->capacity / 2)
+                pthread_cond_wait(&pool->drained, &pool->lock);
+        }
+
+        if (pool->stop)
+            break;
+
+        // the emptier ring first; only the consumers touch it meanwhile, so the room can only grow
+        beaver_kind_t kind = pool->rings[BEAVER_SQUARE].count <= pool->rings[BEAVER_PRODUCT].count ? BEAVER_SQUARE : BEAVER_PRODUCT;
+        beaver_ring_t *ring = &pool->rings[kind];
+        uint32_t count = pool->capacity - ring->count;
+
+        if (count > BEAVER_BATCH)
+            count = BEAVER_BATCH;
+
+        pthread_mutex_unlock(&pool->lock);
+
+        clock_gettime(CLOCK_MONOTONIC, &before);
+        beaver_generate(pool, kind, batch, count);
+        clock_gettime(CLOCK_MONOTONIC, &after);
+
+        pthread_mutex_lock(&pool->lock);
+
+        for (uint32_t k = 0; k < count; k++)
+        {
+            ring->triples[(ring->head + ring->count++) % pool->capacity] = batch[k];
+        }
+
+        pool->generated += count;
+        pool->offline_seconds += (after.tv_sec - before.tv_sec) + (after.tv_nsec - before.tv_nsec) / 1e9;
+
+        pthread_cond_broadcast(&pool->filled);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+beaver_pool_t *beaver_pool_new(context_t *ctx, public_key_t *pk, uint32_t capacity)
+{
+    beaver_pool_t *pool = (beaver_pool_t *)malloc(sizeof(beaver_pool_t));
+    check_null_pointer(pool);
+
+    pool->n = ctx->n;
+    pool->threshold = ctx->threshold;
+    pool->capacity = capacity;
+    pool->stop = 0;
+    pool->refill = 0;
+    pool->generated = 0;
+    pool->offline_seconds = 0;
+
+    mpz_init_set(pool->N, pk->N);
+    gmp_randinit_derived(pool->prng, ctx->prng);
+
+    pool->lambda = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(pool->lambda);
+
+    mpz_point_t *points = beaver_points(ctx->n);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_init(pool->lambda[i]);
+    }
+
+    lagrange_coefficients_at_zero(pool->lambda, points, ctx->n, pool->N);
+
+    beaver_points_free(points, ctx->n);
+
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        pool->rings[k].triples = (beaver_triple_t *)malloc(capacity * sizeof(beaver_triple_t));
+        check_null_pointer(pool->rings[k].triples);
+
+        pool->rings[k].head = 0;
+        pool->rings[k].count = 0;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->filled, NULL);
+    pthread_cond_init(&pool->drained, NULL);
+
+    if (pthread_create(&pool->producer, NULL, beaver_producer, pool) != 0)
+    {
+        fputs("Error while starting the triple producer.", stderr);
+        exit(-1);
+    }
+
+    return pool;
+}
+
+void beaver_pool_free(beaver_pool_t *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->drained);
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_join(pool->producer, NULL);
+
+    for (uint32_t k = 0; k < 2; k++)
+    {
+        beaver_ring_t *ring = &pool->rings[k];
+
+        for (uint32_t i = 0; i < ring->count; i++)
+        {
+            beaver_triple_clear(&ring->triples[(ring->head + i) % pool->capacity], pool->n);
+        }
+
+        free(ring->triples);
+    }
+
+    for (uint32_t i = 0; i < pool->n; i++)
+    {
+        mpz_clear(pool->lambda[i]);
+    }
+
+    free(pool->lambda);
+
+    mpz_clear(pool->N);
+    gmp_randclear(pool->prng);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->filled);
+    pthread_cond_destroy(&pool->drained);
+
+    free(pool);
+}
+
+void beaver_pool_wait_full(beaver_pool_t *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+
+    while (pool->rings[BEAVER_SQUARE].count < pool->capacity || pool->rings[BEAVER_PRODUCT].count < pool->capacity)
+    {
+        pool->refill = 1;
+        pthread_cond_signal(&pool->drained);
+        pthread_cond_wait(&pool->filled, &pool->lock);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void beaver_pool_take(beaver_pool_t *pool, beaver_kind_t kind, beaver_triple_t *triple)
+{
+    beaver_ring_t *ring = &pool->rings[kind];
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (ring->count == 0)
+        pthread_cond_wait(&pool->filled, &pool->lock);
+
+    *triple = ring->triples[ring->head];
+
+    ring->head = (ring->head + 1) % pool->capacity;
+    ring->count--;
+
+    pthread_cond_signal(&pool->drained);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void beaver_open(beaver_pool_t *pool, mpz_t dst, mpz_point_t *shares)
+{
+    mpz_set_ui(dst, 0);
+
+    for (uint32_t i = 0; i < pool->n; i++)
+    {
+        mpz_addmul(dst, pool->lambda[i], shares[i].y);
+    }
+
+    mpz_mod(dst, dst, pool->N);
+}
+
+/**
+ * @brief Opens x - a: every player publishes its masked share and interpolates at zero.
+ */
+static void beaver_open_masked(beaver_pool_t *pool, mpz_t dst, mpz_point_t *x, mpz_point_t *a)
+{
+    mpz_t masked;
+    mpz_init(masked);
+
+    mpz_set_ui(dst, 0);
+
+    for (uint32_t i = 0; i < pool->n; i++)
+    {
+        mpz_sub(masked, x[i].y, a[i].y);
+        mpz_addmul(dst, pool->lambda[i], masked);
+    }
+
+    mpz_mod(dst, dst, pool->N);
+
+    mpz_clear(masked);
+}
+
+void beaver_mult(beaver_pool_t *pool, mpz_point_t *dst, mpz_point_t *x, mpz_point_t *y)
+{
+    beaver_triple_t triple;
+    mpz_t d, e, de;
+
+    mpz_inits(d, e, de, NULL);
+
+    beaver_pool_take(pool, x == y ? BEAVER_SQUARE : BEAVER_PRODUCT, &triple);
+
+    beaver_open_masked(pool, d, x, triple.a);
+
+    if (x == y)
+        mpz_set(e, d);
+    else
+        beaver_open_masked(pool, e, y, triple.b);
+
+    mpz_mul(de, d, e);
+
+    // the opened values are public, each player combines its own shares
+    for (uint32_t i = 0; i < pool->n; i++)
+    {
+        mpz_set_ui(dst[i].x, i + 1);
+
+        mpz_add(dst[i].y, triple.c[i].y, de);
+        mpz_addmul(dst[i].y, d, triple.b[i].y);
+        mpz_addmul(dst[i].y, e, triple.a[i].y);
+        mpz_mod(dst[i].y, dst[i].y, pool->N);
+    }
+
+    beaver_triple_clear(&triple, pool->n);
+
+    mpz_clears(d, e, de, NULL);
+}
@@ -0,0 +1,423 @@
+#include "../include/bench.h"
+
+static const uint32_t bench_moduli_sizes[] = {1024, 2048, 3072, 4096};
+static const uint32_t bench_shares_sizes[] = {3, 5, 9, 16, 32, 64, 128, 256, 512};
+
+// the resharing of every player costs O(n^2 * t), it is only sampled up to this size
+#define BENCH_RESHARE_MAX_N 128
+
+#define bench_array_size(array) (sizeof(array) / sizeof(array[0]))
+
+/**
+ * @brief Threshold used for a given number of shares: the largest one that still allows
+ * the degree reduction in `mult_shamir_ss` (2 * (t - 1) + 1 <= n).
+ */
+static inline uint32_t bench_threshold(uint32_t n)
+{
+    return (n + 1) / 2;
+}
+
+static mpz_t *bench_random_array(context_t *ctx, public_key_t *pk, uint32_t size)
+{
+    mpz_t *array = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(array);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_init(array[i]);
+        mpz_urandomm(array[i], ctx->prng, pk->N);
+    }
+
+    return array;
+}
+
+static void bench_clear_array(mpz_t *array, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_clear(array[i]);
+    }
+
+    free(array);
+}
+
+static void bench_clear_points(mpz_point_t *points, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_clear_point(points[i]);
+    }
+}
+
+static void bench_mpz_set_lbit_prime(context_t *ctx)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t prime;
+    mpz_init(prime);
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_millis,
+        {
+            mpz_set_lbit_prime(prime, ctx->prng, ctx->k / 2);
+        },
+        {});
+
+    snprintf(name, sizeof(name), "mpz_set_lbit_prime k=%u", ctx->k);
+    printf_stats(name, timing, "");
+
+    mpz_clear(prime);
+}
+
+static void bench_mpz_double_pow(context_t *ctx, public_key_t *pk)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t base, dst;
+    mpz_inits(base, dst, NULL);
+    mpz_urandomm(base, ctx->prng, pk->N);
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            mpz_set(dst, base);
+            mpz_double_pow(dst, ctx->T, 0, pk->N);
+        },
+        {});
+
+    snprintf(name, sizeof(name), "mpz_double_pow k=%u T=%u", ctx->k, ctx->T);
+    printf_stats(name, timing, "");
+
+    mpz_clears(base, dst, NULL);
+}
+
+static void bench_fixed_limb_double_pow(context_t *ctx, public_key_t *pk)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t base, dst;
+    mpz_inits(base, dst, NULL);
+    mpz_urandomm(base, ctx->prng, pk->N);
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            mpz_set(dst, base);
+            fixed_limb_double_pow(dst, ctx->T + 1, pk->N);
+        },
+        {});
+
+    snprintf(name, sizeof(name), "fixed_limb_double_pow k=%u T=%u", ctx->k, ctx->T);
+    printf_stats(name, timing, "");
+
+    mpz_clears(base, dst, NULL);
+}
+
+static void bench_simd_mont_square_batch(context_t *ctx, public_key_t *pk)
+{
+    const simd_mont_isa_t isas[] = {SIMD_MONT_NONE, SIMD_MONT_AVX2, SIMD_MONT_AVX512_IFMA};
+    const simd_mont_isa_t best = simd_mont_isa();
+
+    stats_t timing;
+    char name[96];
+
+    mpz_t *values = bench_random_array(ctx, pk, BENCH_SQUARE_BATCH_VALUES);
+
+    for (uint32_t i = 0; i < sizeof(isas) / sizeof(isas[0]); i++)
+    {
+        if (simd_mont_set_isa(isas[i]) != isas[i])
+            continue;
+
+        // SIMD_MONT_NONE is the GMP path, one chain at a time
+        perform_wc_time_sampling_period(
+            timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+            {
+                mpz_square_batch(values, BENCH_SQUARE_BATCH_VALUES, BENCH_SQUARE_BATCH_SQUARINGS, pk->N);
+            },
+            {});
+
+        snprintf(name, sizeof(name), "mpz_square_batch %s k=%u x%u", simd_mont_isa_name(isas[i]), ctx->k,
+                 BENCH_SQUARE_BATCH_VALUES);
+        printf_stats(name, timing, "");
+
+        printf("mpz_square_batch %s k=%u: %.0f squarings/s\n", simd_mont_isa_name(isas[i]), ctx->k,
+               BENCH_SQUARE_BATCH_VALUES * BENCH_SQUARE_BATCH_SQUARINGS / (timing->mean * 1e-6));
+    }
+
+    simd_mont_set_isa(best);
+
+    bench_clear_array(values, BENCH_SQUARE_BATCH_VALUES);
+}
+
+static void bench_mpz_mmul_pow_array(context_t *ctx, public_key_t *pk)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t base, dst;
+    mpz_inits(base, dst, NULL);
+    mpz_urandomm(base, ctx->prng, pk->N);
+
+    mpz_t *key = bench_random_array(ctx, pk, ctx->l);
+
+    uint8_t *c = (uint8_t *)malloc(ctx->l * sizeof(uint8_t));
+    check_null_pointer(c);
+
+    for (uint32_t i = 0; i < ctx->l; i++)
+    {
+        c[i] = gmp_urandomb_ui(ctx->prng, 1);
+    }
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            mpz_mmul_pow_array(dst, base, c, (const mpz_t *)key, ctx->l, pk->N);
+        },
+        {});
+
+    snprintf(name, sizeof(name), "mpz_mmul_pow_array k=%u l=%u", ctx->k, ctx->l);
+    printf_stats(name, timing, "");
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            fixed_limb_mmul_pow_array(dst, base, c, (const mpz_t *)key, ctx->l, pk->N);
+        },
+        {});
+
+    snprintf(name, sizeof(name), "fixed_limb_mmul_pow_array k=%u l=%u", ctx->k, ctx->l);
+    printf_stats(name, timing, "");
+
+    free(c);
+    bench_clear_array(key, ctx->l);
+    mpz_clears(base, dst, NULL);
+}
+
+static void bench_mpz_mmul_array(context_t *ctx, public_key_t *pk)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t dst;
+    mpz_init(dst);
+
+    mpz_t *array = bench_random_array(ctx, pk, ctx->n);
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            mpz_mmul_array(dst, array, ctx->n, pk->N);
+        },
+        {});
+
+    snprintf(name, sizeof(name), "mpz_mmul_array k=%u n=%u", ctx->k, ctx->n);
+    printf_stats(name, timing, "");
+
+    bench_clear_array(array, ctx->n);
+    mpz_clear(dst);
+}
+
+static void bench_shamir_ss(context_t *ctx, public_key_t *pk)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t secret;
+    mpz_init(secret);
+    mpz_urandomm(secret, ctx->prng, pk->N);
+
+    mpz_point_t *shares = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(shares);
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            shamir_ss(shares, ctx->n, secret, ctx->threshold, ctx->prng, pk->N);
+        },
+        {
+            bench_clear_points(shares, ctx->n);
+        });
+
+    snprintf(name, sizeof(name), "shamir_ss k=%u n=%u t=%u", ctx->k, ctx->n, ctx->threshold);
+    printf_stats(name, timing, "");
+
+    bench_clear_points(shares, ctx->n);
+    free(shares);
+    mpz_clear(secret);
+}
+
+static void bench_joint_shamir_ss(context_t *ctx, public_key_t *pk)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t *secrets = bench_random_array(ctx, pk, ctx->n);
+
+    mpz_point_t *shares = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(shares);
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            joint_shamir_ss(shares, secrets, ctx->threshold, ctx->n, ctx->prng, pk->N);
+        },
+        {
+            bench_clear_points(shares, ctx->n);
+        });
+
+    snprintf(name, sizeof(name), "joint_shamir_ss k=%u n=%u t=%u", ctx->k, ctx->n, ctx->threshold);
+    printf_stats(name, timing, "");
+
+    bench_clear_points(shares, ctx->n);
+    free(shares);
+    bench_clear_array(secrets, ctx->n);
+}
+
+/**
+ * @brief Samples one secure multiplication, with `mult_shamir_ss` or with `mult_shamir_ss_batch_reshare`.
+ */
+static void bench_mult_shamir_ss(context_t *ctx, public_key_t *pk, uint8_t reshare)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t a, b;
+    mpz_inits(a, b, NULL);
+    mpz_urandomm(a, ctx->prng, pk->N);
+    mpz_urandomm(b, ctx->prng, pk->N);
+
+    mpz_point_t *shares_a = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(shares_a);
+
+    mpz_point_t *shares_b = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(shares_b);
+
+    mpz_point_t *product = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(product);
+
+    shamir_ss(shares_a, ctx->n, a, ctx->threshold, ctx->prng, pk->N);
+    shamir_ss(shares_b, ctx->n, b, ctx->threshold, ctx->prng, pk->N);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_inits(product[i].x, product[i].y, NULL);
+    }
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            if (reshare)
+                mult_shamir_ss_batch_reshare(&product, &shares_a, &shares_b, 1, ctx->n, ctx->threshold, ctx->prng, pk->N);
+            else
+                mult_shamir_ss(product, shares_a, shares_b, ctx->n, ctx->threshold, ctx->prng, pk->N);
+        },
+        {});
+
+    snprintf(name, sizeof(name), "%s k=%u n=%u t=%u", reshare ? "mult_shamir_ss_reshare" : "mult_shamir_ss", ctx->k, ctx->n, ctx->threshold);
+    printf_stats(name, timing, "");
+
+    bench_clear_points(shares_a, ctx->n);
+    bench_clear_points(shares_b, ctx->n);
+    bench_clear_points(product, ctx->n);
+
+    free(shares_a);
+    free(shares_b);
+    free(product);
+
+    mpz_clears(a, b, NULL);
+}
+
+static void bench_lagrange_interpolation(context_t *ctx, public_key_t *pk)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t secret, result, point;
+    mpz_inits(secret, result, NULL);
+    mpz_init_set_ui(point, 0);
+    mpz_urandomm(secret, ctx->prng, pk->N);
+
+    mpz_point_t *shares = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(shares);
+
+    shamir_ss(shares, ctx->n, secret, ctx->threshold, ctx->prng, pk->N);
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_PRIMITIVES_SAMPLING_TIME, BENCH_PRIMITIVES_MAX_SAMPLES, tu_micros,
+        {
+            lagrange_interpolation(result, shares, point, ctx->n, pk->N);
+        },
+        {});
+
+    assert(mpz_cmp(result, secret) == 0);
+
+    snprintf(name, sizeof(name), "lagrange_interpolation k=%u n=%u", ctx->k, ctx->n);
+    printf_stats(name, timing, "");
+
+    bench_clear_points(shares, ctx->n);
+    free(shares);
+    mpz_clears(secret, result, point, NULL);
+}
+
+void bench_primitives(uint32_t max_k, uint32_t max_n)
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+
+    protocol_parameters.l = 160;
+    protocol_parameters.T = 10;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    calibrate_timing_methods();
+
+    for (uint32_t i = 0; i < bench_array_size(bench_moduli_sizes); i++)
+    {
+        if (bench_moduli_sizes[i] > max_k)
+        {
+            continue;
+        }
+
+        protocol_parameters.k = bench_moduli_sizes[i];
+
+        dealer_init_modulo(&protocol_parameters, &PK);
+
+        bench_mpz_set_lbit_prime(&protocol_parameters);
+        bench_mpz_double_pow(&protocol_parameters, &PK);
+        bench_fixed_limb_double_pow(&protocol_parameters, &PK);
+        bench_simd_mont_square_batch(&protocol_parameters, &PK);
+        bench_mpz_mmul_pow_array(&protocol_parameters, &PK);
+
+        for (uint32_t j = 0; j < bench_array_size(bench_shares_sizes); j++)
+        {
+            if (bench_shares_sizes[j] > max_n)
+            {
+                continue;
+            }
+
+            protocol_parameters.n = bench_shares_sizes[j];
+            protocol_parameters.threshold = bench_threshold(protocol_parameters.n);
+
+            bench_mpz_mmul_array(&protocol_parameters, &PK);
+            bench_shamir_ss(&protocol_parameters, &PK);
+            bench_joint_shamir_ss(&protocol_parameters, &PK);
+            bench_lagrange_interpolation(&protocol_parameters, &PK);
+            bench_mult_shamir_ss(&protocol_parameters, &PK, 0);
+
+            if (protocol_parameters.n <= BENCH_RESHARE_MAX_N)
+                bench_mult_shamir_ss(&protocol_parameters, &PK, 1);
+        }
+
+        mpz_clear(PK.N);
+
+        puts("----------------------------------------");
+    }
+
+    gmp_randclear(protocol_parameters.prng);
+}
@@ -0,0 +1,120 @@
+#include "../include/bench.h"
+
+static const random_backend_t bench_random_backends[] = {RANDOM_BACKEND_MT, RANDOM_BACKEND_CHACHA};
+
+static void bench_random_draws(context_t *ctx, public_key_t *pk)
+{
+    stats_t timing;
+    char name[64];
+
+    mpz_t *values = (mpz_t *)malloc(BENCH_RANDOM_VALUES * sizeof(mpz_t));
+    check_null_pointer(values);
+
+    for (uint32_t i = 0; i < BENCH_RANDOM_VALUES; i++)
+    {
+        mpz_init(values[i]);
+    }
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_RANDOM_SAMPLING_TIME, BENCH_RANDOM_MAX_SAMPLES, tu_micros,
+        {
+            for (uint32_t i = 0; i < BENCH_RANDOM_VALUES; i++)
+            {
+                mpz_urandomm(values[i], ctx->prng, pk->N);
+            }
+        },
+        {});
+
+    snprintf(name, sizeof(name), "%s mpz_urandomm x%u k=%u", random_backend_name(random_backend(ctx->prng)),
+             BENCH_RANDOM_VALUES, ctx->k);
+    printf_stats(name, timing, "");
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_RANDOM_SAMPLING_TIME, BENCH_RANDOM_MAX_SAMPLES, tu_micros,
+        {
+            mpz_urandomm_array(values, BENCH_RANDOM_VALUES, ctx->prng, pk->N);
+        },
+        {});
+
+    snprintf(name, sizeof(name), "%s mpz_urandomm_array x%u k=%u", random_backend_name(random_backend(ctx->prng)),
+             BENCH_RANDOM_VALUES, ctx->k);
+    printf_stats(name, timing, "");
+
+    for (uint32_t i = 0; i < BENCH_RANDOM_VALUES; i++)
+    {
+        mpz_clear(values[i]);
+    }
+
+    free(values);
+}
+
+static void bench_random_backend(random_backend_t backend)
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    stats_t timing;
+    char name[64];
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 60;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    random_init(protocol_parameters.prng, backend);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_RANDOM_SAMPLING_TIME, BENCH_RANDOM_MAX_SAMPLES, tu_millis,
+        {
+            keygen(&protocol_parameters, &PK, players);
+        },
+        {
+            cleanup(&protocol_parameters, &PK, players);
+            players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+        });
+
+    snprintf(name, sizeof(name), "%s keygen", random_backend_name(backend));
+    printf_stats(name, timing, "");
+
+    const char *m = __func__;
+    signature_t *signature;
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_RANDOM_SAMPLING_TIME, BENCH_RANDOM_MAX_SAMPLES, tu_millis,
+        {
+            signature = sign(&protocol_parameters, &PK, players, m, 0);
+        },
+        {
+            signature_free(signature);
+        });
+
+    snprintf(name, sizeof(name), "%s sign", random_backend_name(backend));
+    printf_stats(name, timing, "");
+
+    assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+    signature_free(signature);
+
+    bench_random_draws(&protocol_parameters, &PK);
+
+    gmp_randclear(protocol_parameters.prng);
+    cleanup(&protocol_parameters, &PK, players);
+}
+
+void bench_random()
+{
+    printf("[%s] Benchmark started\n", __func__);
+
+    calibrate_timing_methods();
+
+    for (uint32_t i = 0; i < sizeof(bench_random_backends) / sizeof(bench_random_backends[0]); i++)
+    {
+        bench_random_backend(bench_random_backends[i]);
+    }
+
+    puts("----------------------------------------");
+}
@@ -0,0 +1,100 @@
+#include "../include/bench.h"
+#include "../include/runtime.h"
+
+static const uint32_t bench_runtime_shares_sizes[] = {3, 5, 9, 16};
+
+static void bench_runtime_step(context_t *ctx, public_key_t *pk, player_t *players, transport_kind_t kind)
+{
+    stats_t timing;
+    elapsed_time_t time;
+    char name[64];
+
+    const char *m = __func__;
+    const char *transport = transport_name(kind);
+
+    runtime_t *rt = runtime_new(ctx, pk, players, kind);
+
+    signature_t *signature;
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_RUNTIME_SAMPLING_TIME, BENCH_RUNTIME_MAX_SAMPLES, tu_millis,
+        {
+            signature = runtime_sign(rt, m, 0);
+        },
+        {
+            signature_free(signature);
+        });
+
+    snprintf(name, sizeof(name), "runtime_sign %s n=%u", transport, ctx->n);
+    printf_stats(name, timing, "");
+    printf_runtime_stats(name, rt);
+
+#ifndef USE_POLYNOMIAL
+    perform_oneshot_wc_time_sampling(
+        time, tu_millis,
+        {
+            runtime_refresh(rt);
+        });
+
+    snprintf(name, sizeof(name), "runtime_refresh %s n=%u", transport, ctx->n);
+    printf("%s: ", name);
+    printf_et("", time, tu_millis, "\n");
+    printf_runtime_stats(name, rt);
+#endif
+
+    perform_oneshot_wc_time_sampling(
+        time, tu_millis,
+        {
+            runtime_update(rt, players[0].sk.j);
+        });
+
+    snprintf(name, sizeof(name), "runtime_update %s n=%u", transport, ctx->n);
+    printf("%s: ", name);
+    printf_et("", time, tu_millis, "\n");
+    printf_runtime_stats(name, rt);
+
+    runtime_free(rt);
+}
+
+void bench_runtime(uint32_t max_n)
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 60;
+    protocol_parameters.T = 10;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    calibrate_timing_methods();
+
+    for (uint32_t i = 0; i < sizeof(bench_runtime_shares_sizes) / sizeof(bench_runtime_shares_sizes[0]); i++)
+    {
+        if (bench_runtime_shares_sizes[i] > max_n)
+        {
+            continue;
+        }
+
+        protocol_parameters.n = bench_runtime_shares_sizes[i];
+        protocol_parameters.threshold = (protocol_parameters.n + 1) / 2;
+
+        players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+        keygen(&protocol_parameters, &PK, players);
+
+        bench_runtime_step(&protocol_parameters, &PK, players, TRANSPORT_QUEUE);
+        bench_runtime_step(&protocol_parameters, &PK, players, TRANSPORT_SOCKET);
+        bench_runtime_step(&protocol_parameters, &PK, players, TRANSPORT_SHM);
+
+        cleanup(&protocol_parameters, &PK, players);
+
+        puts("----------------------------------------");
+    }
+
+    gmp_randclear(protocol_parameters.prng);
+}
@@ -0,0 +1,108 @@
+#include "../include/bench.h"
+#include "../include/transport.h"
+
+#include <pthread.h>
+
+static const uint32_t bench_transport_message_sizes[] = {128, 1024, 16384, 131072};
+
+/**
+ * @brief Party 1 of the benchmark: echoes every message back to party 0, stops on an empty one.
+ */
+static void *bench_transport_echo(void *arg)
+{
+    transport_t *t = (transport_t *)arg;
+    size_t len;
+
+    for (;;)
+    {
+        uint8_t *data = transport_recv(t, 1, 0, &len);
+
+        transport_send(t, 1, 0, data, len);
+        free(data);
+
+        if (len == 0)
+            return NULL;
+    }
+}
+
+/**
+ * @brief Party 1 of the benchmark: drains `BENCH_TRANSPORT_STREAM_MESSAGES` messages.
+ */
+static void *bench_transport_drain(void *arg)
+{
+    transport_t *t = (transport_t *)arg;
+    size_t len;
+
+    for (uint32_t i = 0; i < BENCH_TRANSPORT_STREAM_MESSAGES; i++)
+    {
+        free(transport_recv(t, 1, 0, &len));
+    }
+
+    return NULL;
+}
+
+static void bench_transport_kind(transport_kind_t kind, uint32_t size)
+{
+    stats_t timing;
+    elapsed_time_t time;
+    char name[64];
+    pthread_t peer;
+    size_t len;
+
+    uint8_t *message = (uint8_t *)calloc(size, sizeof(uint8_t));
+    check_null_pointer(message);
+
+    transport_t *t = transport_new(kind, 2);
+
+    pthread_create(&peer, NULL, bench_transport_echo, t);
+
+    perform_wc_time_sampling_period(
+        timing, BENCH_TRANSPORT_SAMPLING_TIME, BENCH_TRANSPORT_MAX_SAMPLES, tu_micros,
+        {
+            transport_send(t, 0, 1, message, size);
+            free(transport_recv(t, 0, 1, &len));
+        },
+        {});
+
+    transport_send(t, 0, 1, message, 0);
+    free(transport_recv(t, 0, 1, &len));
+    pthread_join(peer, NULL);
+
+    snprintf(name, sizeof(name), "transport round trip %s size=%u", transport_name(kind), size);
+    printf_stats(name, timing, "");
+
+    pthread_create(&peer, NULL, bench_transport_drain, t);
+
+    perform_oneshot_wc_time_sampling(
+        time, tu_sec,
+        {
+            for (uint32_t i = 0; i < BENCH_TRANSPORT_STREAM_MESSAGES; i++)
+            {
+                transport_send(t, 0, 1, message, size);
+            }
+
+            pthread_join(peer, NULL);
+        });
+
+    printf("transport stream %s size=%u: %.1f MB/s\n", transport_name(kind), size,
+           (double)BENCH_TRANSPORT_STREAM_MESSAGES * size / time / 1e6);
+
+    transport_free(t);
+    free(message);
+}
+
+void bench_transport()
+{
+    printf("[%s] Benchmark started\n", __func__);
+
+    calibrate_timing_methods();
+
+    for (uint32_t i = 0; i < sizeof(bench_transport_message_sizes) / sizeof(bench_transport_message_sizes[0]); i++)
+    {
+        bench_transport_kind(TRANSPORT_QUEUE, bench_transport_message_sizes[i]);
+        bench_transport_kind(TRANSPORT_SOCKET, bench_transport_message_sizes[i]);
+        bench_transport_kind(TRANSPORT_SHM, bench_transport_message_sizes[i]);
+    }
+
+    puts("----------------------------------------");
+}
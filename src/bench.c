@@ -1,4 +1,46 @@
 #include "../include/bench.h"
+#include "../include/evolver.h"
+
+#include <unistd.h>
+
+#ifdef USE_ALLOC_PROFILER
+
+/**
+ * @brief Reports the allocations of a single call of each protocol operation.
+ *
+ * The calls are made outside the timed loops so that the profiler bookkeeping does not
+ * end up in the timings. The key is left in the next period.
+ */
+static void bench_alloc_profile(context_t *ctx, public_key_t *pk, player_t *players, const char *m)
+{
+    alloc_profile_t profile;
+
+    alloc_profiler_begin();
+    signature_t *signature = sign(ctx, pk, players, m, 0);
+    alloc_profiler_end(&profile);
+    printf_alloc_profile("sign", &profile);
+
+    alloc_profiler_begin();
+    verify(ctx, pk, m, signature);
+    alloc_profiler_end(&profile);
+    printf_alloc_profile("verify", &profile);
+
+    signature_free(signature);
+
+#ifndef USE_POLYNOMIAL
+    alloc_profiler_begin();
+    refresh(ctx, pk, players);
+    alloc_profiler_end(&profile);
+    printf_alloc_profile("refresh", &profile);
+#endif
+
+    alloc_profiler_begin();
+    update(ctx, pk, players, 0);
+    alloc_profiler_end(&profile);
+    printf_alloc_profile("update", &profile);
+}
+
+#endif
 
 void bench_sign()
 {
@@ -7,7 +49,9 @@ void bench_sign()
     player_t *players;
 
     stats_t timing;
+    histogram_t latency;
     elapsed_time_t time;
+    alloc_profile_t profile;
 
     protocol_parameters.k = 1024;
     protocol_parameters.l = 60;
@@ -17,7 +61,7 @@ void bench_sign()
 
     printf("[%s] Benchmark started\n", __func__);
 
-    gmp_randinit_default(protocol_parameters.prng);
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
     gmp_randseed_os_rng(protocol_parameters.prng, 128);
 
     players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
@@ -26,29 +70,40 @@ void bench_sign()
 
     calibrate_timing_methods();
 
+    alloc_profiler_begin();
+
     perform_oneshot_wc_time_sampling(
         time, tu_millis,
         {
             keygen(&protocol_parameters, &PK, players);
         });
 
+    alloc_profiler_end(&profile);
+
     printf_et("keygen: ", time, tu_millis, "\n");
+    printf_alloc_profile("keygen", &profile);
 
     signature_t *signature;
 
-    perform_wc_time_sampling_period(
-        timing, BENCH_SAMPLING_TIME, MAX_SAMPLES, tu_millis,
+    histogram_init(latency);
+
+    perform_wc_time_histogram_sampling_period(
+        timing, latency, BENCH_SAMPLING_TIME, tu_millis,
         {
             signature = sign(&protocol_parameters, &PK, players, m, 0);
         },
-        {});
+        {
+            signature_free(signature);
+        });
 
     printf_stats("sign", timing, "");
 
     uint8_t res;
 
-    perform_wc_time_sampling_period(
-        timing, BENCH_SAMPLING_TIME, MAX_SAMPLES, tu_millis,
+    histogram_init(latency);
+
+    perform_wc_time_histogram_sampling_period(
+        timing, latency, BENCH_SAMPLING_TIME, tu_millis,
         {
             res = verify(&protocol_parameters, &PK, m, signature);
         },
@@ -58,9 +113,602 @@ void bench_sign()
 
     assert(res == 1);
 
+    histogram_init(latency);
+
+    perform_wc_time_histogram_sampling_period(
+        timing, latency, BENCH_SAMPLING_TIME, tu_millis,
+        {
+            res = verify_parallel(&protocol_parameters, &PK, m, signature);
+        },
+        {});
+
+    printf_stats("verify_parallel", timing, "");
+
+    assert(res == 1);
+
+#ifdef USE_ALLOC_PROFILER
+    bench_alloc_profile(&protocol_parameters, &PK, players, m);
+#endif
+
     puts("----------------------------------------");
 
     signature_free(signature);
     gmp_randclear(protocol_parameters.prng);
     cleanup(&protocol_parameters, &PK, players);
-}
\ No newline at end of file
+}
+
+static const uint32_t bench_batch_sizes[] = {1, 4, 16, 64, 256, 1024};
+
+void bench_sign_batch()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    elapsed_time_t batch_time, loop_time;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 60;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    calibrate_timing_methods();
+
+    keygen(&protocol_parameters, &PK, players);
+
+    for (uint32_t i = 0; i < sizeof(bench_batch_sizes) / sizeof(bench_batch_sizes[0]); i++)
+    {
+        uint32_t count = bench_batch_sizes[i];
+
+        const char **msgs = (const char **)malloc(count * sizeof(char *));
+        check_null_pointer(msgs);
+
+        signature_t *signatures = (signature_t *)malloc(count * sizeof(signature_t));
+        check_null_pointer(signatures);
+
+        for (uint32_t k = 0; k < count; k++)
+        {
+            msgs[k] = __func__;
+        }
+
+        perform_oneshot_wc_time_sampling(
+            batch_time, tu_sec,
+            {
+                sign_batch(&protocol_parameters, &PK, players, msgs, count, 0, signatures);
+            });
+
+        for (uint32_t k = 0; k < count; k++)
+        {
+            signature_clear(&signatures[k]);
+        }
+
+        perform_oneshot_wc_time_sampling(
+            loop_time, tu_sec,
+            {
+                for (uint32_t k = 0; k < count; k++)
+                {
+                    signature_free(sign(&protocol_parameters, &PK, players, msgs[k], 0));
+                }
+            });
+
+        printf("sign_batch count=%u: %.1f sig/s per core, sign loop: %.1f sig/s per core\n", count,
+               count / batch_time, count / loop_time);
+
+        free(signatures);
+        free(msgs);
+    }
+
+    puts("----------------------------------------");
+
+    gmp_randclear(protocol_parameters.prng);
+    cleanup(&protocol_parameters, &PK, players);
+}
+
+void bench_sign_quorum()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+    quorum_t quorum;
+
+    elapsed_time_t all_time, quorum_time;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 60;
+    protocol_parameters.n = 9;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    calibrate_timing_methods();
+
+    keygen(&protocol_parameters, &PK, players);
+
+#ifdef USE_POLYNOMIAL
+    quorum_init_mask(&quorum, (1 << (2 * protocol_parameters.threshold - 1)) - 1);
+#else
+    quorum_init_mask(&quorum, (1 << protocol_parameters.n) - 1);
+#endif
+
+    const char *m = __func__;
+
+    perform_oneshot_wc_time_sampling(
+        all_time, tu_sec,
+        {
+            for (uint32_t k = 0; k < BENCH_SIGN_QUORUM_SIGNATURES; k++)
+            {
+                signature_free(sign(&protocol_parameters, &PK, players, m, 0));
+            }
+        });
+
+    perform_oneshot_wc_time_sampling(
+        quorum_time, tu_sec,
+        {
+            for (uint32_t k = 0; k < BENCH_SIGN_QUORUM_SIGNATURES; k++)
+            {
+                signature_free(sign_quorum(&protocol_parameters, &PK, players, &quorum, m, 0));
+            }
+        });
+
+    printf("sign n=%u: %.1f sig/s, sign_quorum of %u: %.1f sig/s\n", protocol_parameters.n,
+           BENCH_SIGN_QUORUM_SIGNATURES / all_time, quorum_size(&quorum), BENCH_SIGN_QUORUM_SIGNATURES / quorum_time);
+
+    puts("----------------------------------------");
+
+    quorum_cache_clear();
+
+    gmp_randclear(protocol_parameters.prng);
+    cleanup(&protocol_parameters, &PK, players);
+}
+
+void bench_keygen_seeded()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    elapsed_time_t plain_time, seeded_time;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = BENCH_KEYGEN_SEEDED_PLAYERS;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    calibrate_timing_methods();
+
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    perform_oneshot_wc_time_sampling(plain_time, tu_millis, { keygen(&protocol_parameters, &PK, players); });
+
+    size_t plain_bytes = provision_plain_size(protocol_parameters.n, protocol_parameters.l, PK.N);
+
+    cleanup(&protocol_parameters, &PK, players);
+
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    provision_t *provision;
+
+    perform_oneshot_wc_time_sampling(seeded_time, tu_millis, { provision = keygen_seeded(&protocol_parameters, &PK, players); });
+
+    printf("n=%u l=%u: keygen %.3f ms, %zu bytes dealt, keygen_seeded %.3f ms, %zu bytes dealt (%u seeded players)\n",
+           protocol_parameters.n, protocol_parameters.l, plain_time, plain_bytes, seeded_time,
+           provision_size(provision, PK.N), provision->seeded);
+
+    puts("----------------------------------------");
+
+    provision_free(provision);
+
+    gmp_randclear(protocol_parameters.prng);
+    cleanup(&protocol_parameters, &PK, players);
+}
+
+void bench_evolver()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    elapsed_time_t time, inline_times[2] = {0, 0}, evolver_times[2] = {0, 0};
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 8;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = BENCH_EVOLVER_PERIODS;
+
+    uint32_t count = BENCH_EVOLVER_PERIODS * BENCH_EVOLVER_PERIOD_SIGNATURES;
+    uint32_t boundaries = BENCH_EVOLVER_PERIODS - 1;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    calibrate_timing_methods();
+
+    const char *m = __func__;
+
+    // the requests arrive every BENCH_EVOLVER_INTERVAL_US, the one at a period boundary waits for the update
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    keygen(&protocol_parameters, &PK, players);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        perform_oneshot_wc_time_sampling(
+            time, tu_millis,
+            {
+                if (k > 0 && k % BENCH_EVOLVER_PERIOD_SIGNATURES == 0)
+                    update(&protocol_parameters, &PK, players, players[0].sk.j);
+
+                signature_free(sign(&protocol_parameters, &PK, players, m, players[0].sk.j));
+            });
+
+        usleep(BENCH_EVOLVER_INTERVAL_US);
+
+        // [0] within a period, [1] at its boundary
+        inline_times[k > 0 && k % BENCH_EVOLVER_PERIOD_SIGNATURES == 0] += time;
+    }
+
+    cleanup(&protocol_parameters, &PK, players);
+
+    // the same with the next period computed in the background
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    keygen(&protocol_parameters, &PK, players);
+
+    evolver_t *evolver = evolver_new(&protocol_parameters, &PK, players);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        perform_oneshot_wc_time_sampling(
+            time, tu_millis,
+            {
+                if (k > 0 && k % BENCH_EVOLVER_PERIOD_SIGNATURES == 0)
+                    evolver_advance(evolver);
+
+                signature_free(evolver_sign(evolver, &protocol_parameters, m));
+            });
+
+        usleep(BENCH_EVOLVER_INTERVAL_US);
+
+        evolver_times[k > 0 && k % BENCH_EVOLVER_PERIOD_SIGNATURES == 0] += time;
+    }
+
+    printf("n=%u l=%u, %u signatures per period: update inline %.3f ms, %.3f ms at the boundaries; evolver %.3f ms, %.3f ms at the boundaries (%.3f ms per period in the background)\n",
+           protocol_parameters.n, protocol_parameters.l, BENCH_EVOLVER_PERIOD_SIGNATURES,
+           inline_times[0] / (count - boundaries), inline_times[1] / boundaries,
+           evolver_times[0] / (count - boundaries), evolver_times[1] / boundaries,
+           evolver->offline_seconds * 1000 / evolver->transitions);
+
+    puts("----------------------------------------");
+
+    players = evolver_free(evolver);
+
+    gmp_randclear(protocol_parameters.prng);
+    cleanup(&protocol_parameters, &PK, players);
+}
+
+#ifndef USE_POLYNOMIAL
+
+void bench_keygen_distributed()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    elapsed_time_t dealer_time, player_time, combine_time;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    calibrate_timing_methods();
+
+    // the modulus is the same for both, only the shares and the public key are timed
+    for (uint32_t n = 4; n <= BENCH_KEYGEN_DISTRIBUTED_MAX_N; n *= 4)
+    {
+        protocol_parameters.n = n;
+
+        players = (player_t *)malloc(n * sizeof(player_t));
+
+        keygen(&protocol_parameters, &PK, players);
+
+        perform_oneshot_wc_time_sampling(
+            dealer_time, tu_millis,
+            {
+                for (uint32_t i = 0; i < protocol_parameters.l; i++)
+                {
+                    for (uint32_t j = 0; j < n; j++)
+                    {
+                        dealer_set_player_private_key_i(&protocol_parameters, players[j].sk, i);
+                    }
+
+                    dealer_multiplicative_compute_public_key_i(&protocol_parameters, &PK, players, i);
+                }
+            });
+
+        key_store_t *partials = key_store_new(n * protocol_parameters.l, PK.N);
+
+        // what each player runs on its own hardware, then the combine
+        for (uint32_t j = 0; j < n; j++)
+        {
+            player_multiplicative_compute_partials(&protocol_parameters, &PK, &players[j], key_store_views(partials, j * protocol_parameters.l), protocol_parameters.prng);
+        }
+
+        perform_oneshot_wc_time_sampling(
+            player_time, tu_millis,
+            {
+                player_multiplicative_compute_partials(&protocol_parameters, &PK, &players[0], key_store_views(partials, 0), protocol_parameters.prng);
+            });
+
+        perform_oneshot_wc_time_sampling(
+            combine_time, tu_millis,
+            {
+                for (uint32_t i = 0; i < protocol_parameters.l; i++)
+                {
+                    dealer_multiplicative_combine_public_key_i(&protocol_parameters, &PK, partials, i);
+                }
+            });
+
+        printf("n=%u l=%u: dealer %.3f ms, distributed: %.3f ms per player + combine %.3f ms\n",
+               n, protocol_parameters.l, dealer_time, player_time, combine_time);
+
+        key_store_free(partials);
+
+        cleanup(&protocol_parameters, &PK, players);
+    }
+
+    puts("----------------------------------------");
+
+    gmp_randclear(protocol_parameters.prng);
+}
+
+void bench_sign_checked()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    elapsed_time_t time, plain = 0, checked = 0, faulty = 0;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 8;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    calibrate_timing_methods();
+
+    keygen(&protocol_parameters, &PK, players);
+
+    uint8_t *flags = (uint8_t *)malloc(protocol_parameters.n);
+    check_null_pointer(flags);
+
+    const char *m = __func__;
+
+    for (uint32_t k = 0; k < BENCH_SIGN_CHECKED_SIGNATURES; k++)
+    {
+        perform_oneshot_wc_time_sampling(
+            time, tu_millis,
+            {
+                signature_free(sign(&protocol_parameters, &PK, players, m, 0));
+            });
+
+        plain += time;
+
+        perform_oneshot_wc_time_sampling(
+            time, tu_millis,
+            {
+                signature_free(sign_checked(&protocol_parameters, &PK, players, m, 0, flags));
+            });
+
+        checked += time;
+    }
+
+    // the last player contributes with a wrong first share: the round goes through verify_partials
+    mpz_t share, wrong;
+    mpz_init_set(share, players[protocol_parameters.n - 1].sk.S[0]);
+    mpz_init(wrong);
+
+    mpz_add_ui(wrong, share, 1);
+    mpz_mod(players[protocol_parameters.n - 1].sk.S[0], wrong, PK.N);
+
+    for (uint32_t k = 0; k < BENCH_SIGN_CHECKED_SIGNATURES; k++)
+    {
+        signature_t *signature;
+
+        perform_oneshot_wc_time_sampling(time, tu_millis, { signature = sign_checked(&protocol_parameters, &PK, players, m, 0, flags); });
+
+        faulty += time;
+
+        // NULL unless the digest skips the wrong share
+        if (signature != NULL)
+            signature_free(signature);
+    }
+
+    mpz_set(players[protocol_parameters.n - 1].sk.S[0], share);
+    mpz_clears(share, wrong, NULL);
+
+    printf("n=%u l=%u: sign %.3f ms, sign_checked %.3f ms, with a faulty player %.3f ms\n",
+           protocol_parameters.n, protocol_parameters.l, plain / BENCH_SIGN_CHECKED_SIGNATURES,
+           checked / BENCH_SIGN_CHECKED_SIGNATURES, faulty / BENCH_SIGN_CHECKED_SIGNATURES);
+
+    puts("----------------------------------------");
+
+    free(flags);
+
+    gmp_randclear(protocol_parameters.prng);
+    cleanup(&protocol_parameters, &PK, players);
+}
+
+#endif
+
+#ifdef USE_POLYNOMIAL
+
+void bench_sign_beaver()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    elapsed_time_t time, online = 0, resharing = 0;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 60;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+    calibrate_timing_methods();
+
+    keygen(&protocol_parameters, &PK, players);
+
+    beaver_pool_t *pool = beaver_pool_new(&protocol_parameters, &PK, BEAVER_DEFAULT_CAPACITY);
+
+    const char *m = __func__;
+
+    // the pool is refilled before every signature, so only the online work is timed
+    for (uint32_t k = 0; k < BENCH_SIGN_BEAVER_SIGNATURES; k++)
+    {
+        beaver_pool_wait_full(pool);
+
+        perform_oneshot_wc_time_sampling(
+            time, tu_millis,
+            {
+                signature_free(sign_beaver(&protocol_parameters, &PK, players, pool, m, 0));
+            });
+
+        online += time;
+
+        perform_oneshot_wc_time_sampling(
+            time, tu_millis,
+            {
+                signature_free(sign(&protocol_parameters, &PK, players, m, 0));
+            });
+
+        resharing += time;
+    }
+
+    beaver_pool_wait_full(pool);
+
+    printf("sign: %.3f ms, sign_beaver online: %.3f ms, offline: %.3f ms per triple (%lu triples)\n",
+           resharing / BENCH_SIGN_BEAVER_SIGNATURES, online / BENCH_SIGN_BEAVER_SIGNATURES,
+           pool->offline_seconds * 1000 / pool->generated, (unsigned long)pool->generated);
+
+    puts("----------------------------------------");
+
+    beaver_pool_free(pool);
+
+    gmp_randclear(protocol_parameters.prng);
+    cleanup(&protocol_parameters, &PK, players);
+}
+
+void bench_update_packed()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    elapsed_time_t update_time, sign_time;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 16;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = BENCH_UPDATE_PACKED_ROUNDS;
+
+    printf("[%s] Benchmark started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    calibrate_timing_methods();
+
+    uint32_t max_factor = packed_max_factor(protocol_parameters.n, protocol_parameters.threshold);
+
+    const char *m = __func__;
+
+    // factor 1 is the plain keygen
+    for (uint32_t factor = 1; factor <= max_factor; factor++)
+    {
+        players = (player_t *)malloc(protocol_parameters.n * sizeof(player_t));
+
+        if (factor == 1)
+            keygen(&protocol_parameters, &PK, players);
+        else
+            keygen_packed(&protocol_parameters, &PK, players, factor);
+
+        key_store_t *store = players[0].sk.store;
+        size_t bytes = (size_t)store->count / protocol_parameters.n * store->stride * sizeof(mp_limb_t);
+
+        perform_oneshot_wc_time_sampling(
+            sign_time, tu_millis,
+            {
+                signature_free(sign_packed(&protocol_parameters, &PK, players, m, 0));
+            });
+
+        perform_oneshot_wc_time_sampling(
+            update_time, tu_millis,
+            {
+                for (uint32_t j = 0; j < BENCH_UPDATE_PACKED_ROUNDS; j++)
+                {
+                    update_packed(&protocol_parameters, &PK, players, j);
+                }
+            });
+
+        printf("n=%u t=%u l=%u factor=%u: %zu bytes per player, %u resharings per period, update: %.3f ms, sign: %.3f ms\n",
+               protocol_parameters.n, protocol_parameters.threshold, protocol_parameters.l, factor, bytes,
+               store->count / protocol_parameters.n, update_time / BENCH_UPDATE_PACKED_ROUNDS, sign_time);
+
+        cleanup(&protocol_parameters, &PK, players);
+    }
+
+    puts("----------------------------------------");
+
+    packed_cache_clear();
+
+    gmp_randclear(protocol_parameters.prng);
+}
+
+#endif
@@ -1,25 +1,61 @@
 #include "../include/dealer.h"
 
+typedef struct
+{
+    uint32_t bits;
+    mpz_t primes[2];
+    gmp_randstate_t prngs[2];
+} dealer_primes_job_t;
+
+static void dealer_find_prime(uint32_t idx, void *arg)
+{
+    dealer_primes_job_t *job = (dealer_primes_job_t *)arg;
+
+    mpz_set_lbit_prime(job->primes[idx], job->prngs[idx], job->bits);
+}
+
 void dealer_init_modulo(context_t *ctx, public_key_t *pk)
 {
-    mpz_t p, q;
+    dealer_primes_job_t job;
 
-    mpz_inits(p, q, pk->N, NULL);
+    job.bits = ctx->k / 2;
 
-    mpz_set_lbit_prime(p, ctx->prng, ctx->k / 2);
+    mpz_init(pk->N);
 
-    do
+    for (uint32_t i = 0; i < 2; i++)
     {
-        mpz_set_lbit_prime(q, ctx->prng, ctx->k / 2);
-    } while (mpz_cmp(p, q) == 0);
+        mpz_init(job.primes[i]);
+        gmp_randinit_derived(job.prngs[i], ctx->prng);
+    }
 
-    mpz_mul(pk->N, p, q);
+    // p and q are searched on separate threads
+    parallel_for(2, dealer_find_prime, &job);
 
-    mpz_clears(p, q, NULL);
+    while (mpz_cmp(job.primes[0], job.primes[1]) == 0)
+    {
+        mpz_set_lbit_prime(job.primes[1], job.prngs[1], job.bits);
+    }
+
+    mpz_mul(pk->N, job.primes[0], job.primes[1]);
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        mpz_clear(job.primes[i]);
+        gmp_randclear(job.prngs[i]);
+    }
 }
 
 void dealer_init_players(context_t *ctx, public_key_t *pk, player_t *players)
 {
+    dealer_init_players_packed(ctx, pk, players, 1);
+}
+
+void dealer_init_players_packed(context_t *ctx, public_key_t *pk, player_t *players, uint32_t packing)
+{
+    uint32_t width = (ctx->l + packing - 1) / packing;
+
+    key_store_t *store = key_store_new(ctx->n * width, pk->N);
+
     for (uint32_t i = 0; i < ctx->n; i++)
     {
         players[i].id = i;
@@ -28,16 +64,35 @@ void dealer_init_players(context_t *ctx, public_key_t *pk, player_t *players)
 
         players[i].sk.j = 0;
         players[i].sk.T = ctx->T;
-        players[i].sk.S = (mpz_t *)malloc(ctx->l * sizeof(mpz_t));
-
-        check_null_pointer(players[i].sk.S);
+        players[i].sk.packing = packing;
+        players[i].sk.store = store;
+        players[i].sk.S = key_store_views(store, i * width);
     }
 }
 
 void dealer_init_pk(context_t *ctx, public_key_t *pk)
 {
     pk->T = ctx->T;
-    pk->U = (mpz_t *)malloc(ctx->l * sizeof(mpz_t));
+    pk->store = key_store_new(ctx->l, pk->N);
+    pk->U = key_store_views(pk->store, 0);
+
+    pk->verification = NULL;
+    pk->V = NULL;
+}
+
+void dealer_multiplicative_init_verification_keys(context_t *ctx, public_key_t *pk, player_t *players)
+{
+    pk->verification = key_store_new(ctx->n * ctx->l, pk->N);
+    pk->V = key_store_views(pk->verification, 0);
+
+    for (uint32_t p = 0; p < ctx->n; p++)
+    {
+        for (uint32_t i = 0; i < ctx->l; i++)
+        {
+            mpz_set(pk->V[p * ctx->l + i], players[p].sk.S[i]);
+        }
+    }
 
-    check_null_pointer(pk->U);
+    // the n * l chains are independent: square them side by side
+    mpz_double_pow_batch(pk->V, ctx->n * ctx->l, pk->T, 0, pk->N);
 }
\ No newline at end of file
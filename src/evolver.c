@@ -0,0 +1,291 @@
+// SCHED_IDLE
+#define _GNU_SOURCE
+
+#include "../include/evolver.h"
+#include "../include/key-store.h"
+
+#include <sched.h>
+#include <time.h>
+
+/**
+ * @brief Allocates the players of the shadow state, with shares of their own and at zero.
+ */
+static void evolver_state_init(context_t *ctx, evolver_state_t *state, const player_t *players)
+{
+    // packed keys hold a share per pack, as dealt by dealer_init_players_packed
+    uint32_t width = (ctx->l + players[0].sk.packing - 1) / players[0].sk.packing;
+
+    state->store = key_store_new(ctx->n * width, players[0].sk.N);
+
+    state->players = (player_t *)malloc(ctx->n * sizeof(player_t));
+    check_null_pointer(state->players);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        state->players[i].id = players[i].id;
+
+        mpz_init_set(state->players[i].sk.N, players[i].sk.N);
+
+        state->players[i].sk.S = key_store_views(state->store, i * width);
+        state->players[i].sk.store = state->store;
+        state->players[i].sk.packing = players[i].sk.packing;
+        state->players[i].sk.T = players[i].sk.T;
+        state->players[i].sk.j = players[i].sk.j;
+    }
+
+    atomic_init(&state->readers, 0);
+}
+
+static void evolver_state_free(context_t *ctx, evolver_state_t *state)
+{
+    key_store_free(state->store);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_clear(state->players[i].sk.N);
+    }
+
+    free(state->players);
+}
+
+static evolver_state_t *evolver_shadow(evolver_t *evolver, evolver_state_t *current)
+{
+    return current == &evolver->states[0] ? &evolver->states[1] : &evolver->states[0];
+}
+
+/**
+ * @brief Sets the shadow state, already wiped, to the period after the current one.
+ *
+ * @return 1 on success, 0 if the stores of the two states do not match.
+ */
+static uint8_t evolver_state_evolve(evolver_t *evolver, evolver_state_t *shadow, const evolver_state_t *current)
+{
+    uint32_t j = current->players[0].sk.j;
+
+    if (!key_store_copy(shadow->store, current->store))
+        return 0;
+
+    for (uint32_t i = 0; i < evolver->ctx.n; i++)
+    {
+        shadow->players[i].sk.j = j;
+    }
+
+#ifdef USE_POLYNOMIAL
+    update_packed(&evolver->ctx, evolver->pk, shadow->players, j);
+#else
+    update(&evolver->ctx, evolver->pk, shadow->players, j);
+#endif
+
+    return 1;
+}
+
+/**
+ * @brief Wipes the swapped out state once no signer pins it, with the lock held.
+ */
+static void evolver_retire(evolver_t *evolver, evolver_state_t *state)
+{
+    if (!evolver->retired || state == atomic_load(&evolver->current) || atomic_load(&state->readers) > 0)
+        return;
+
+    key_store_wipe(state->store);
+
+    evolver->retired = 0;
+    pthread_cond_broadcast(&evolver->changed);
+}
+
+static void *evolver_worker(void *arg)
+{
+    evolver_t *evolver = (evolver_t *)arg;
+    struct timespec before, after;
+
+#ifdef SCHED_IDLE
+    // the next period is computed on the time the signers leave idle: with no core to spare it
+    // does not slow them down, and `evolver_advance` waits for it only under a sustained load
+    struct sched_param param = {0};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+
+    pthread_mutex_lock(&evolver->lock);
+
+    for (;;)
+    {
+        // the old period is wiped by its last signer, see evolver_retire
+        while (!evolver->stop && (!evolver->stale || evolver->retired))
+            pthread_cond_wait(&evolver->changed, &evolver->lock);
+
+        if (evolver->stop)
+            break;
+
+        evolver_state_t *current = atomic_load(&evolver->current);
+        evolver_state_t *shadow = evolver_shadow(evolver, current);
+
+        // the current state only changes in evolver_advance, which waits for this one
+        pthread_mutex_unlock(&evolver->lock);
+
+        clock_gettime(CLOCK_MONOTONIC, &before);
+
+        uint8_t ready = current->players[0].sk.j < evolver->ctx.T;
+
+        if (ready)
+            ready = evolver_state_evolve(evolver, shadow, current);
+
+        clock_gettime(CLOCK_MONOTONIC, &after);
+
+        pthread_mutex_lock(&evolver->lock);
+
+        evolver->offline_seconds += (after.tv_sec - before.tv_sec) + (after.tv_nsec - before.tv_nsec) / 1e9;
+        evolver->ready = ready;
+        evolver->stale = 0;
+
+        pthread_cond_broadcast(&evolver->changed);
+    }
+
+    pthread_mutex_unlock(&evolver->lock);
+
+#ifdef USE_POLYNOMIAL
+    // the packing coefficients of update_packed are cached per thread
+    packed_cache_clear();
+#endif
+
+    return NULL;
+}
+
+evolver_t *evolver_new(context_t *ctx, public_key_t *pk, player_t *players)
+{
+    evolver_t *evolver = (evolver_t *)malloc(sizeof(evolver_t));
+    check_null_pointer(evolver);
+
+    evolver->ctx.l = ctx->l;
+    evolver->ctx.n = ctx->n;
+    evolver->ctx.k = ctx->k;
+    evolver->ctx.T = ctx->T;
+    evolver->ctx.threshold = ctx->threshold;
+    gmp_randinit_derived(evolver->ctx.prng, ctx->prng);
+
+    evolver->pk = pk;
+
+    evolver->states[0].players = players;
+    evolver->states[0].store = players[0].sk.store;
+    atomic_init(&evolver->states[0].readers, 0);
+
+    evolver_state_init(ctx, &evolver->states[1], players);
+
+    atomic_init(&evolver->current, &evolver->states[0]);
+
+    evolver->stop = 0;
+    evolver->ready = 0;
+    evolver->stale = 1;
+    evolver->retired = 0;
+    evolver->transitions = 0;
+    evolver->offline_seconds = 0;
+
+    pthread_mutex_init(&evolver->lock, NULL);
+    pthread_cond_init(&evolver->changed, NULL);
+
+    if (pthread_create(&evolver->worker, NULL, evolver_worker, evolver) != 0)
+    {
+        fputs("Error while starting the key evolution worker.", stderr);
+        exit(-1);
+    }
+
+    return evolver;
+}
+
+player_t *evolver_free(evolver_t *evolver)
+{
+    pthread_mutex_lock(&evolver->lock);
+    evolver->stop = 1;
+    pthread_cond_broadcast(&evolver->changed);
+    pthread_mutex_unlock(&evolver->lock);
+
+    pthread_join(evolver->worker, NULL);
+
+    evolver_state_t *current = atomic_load(&evolver->current);
+    player_t *players = current->players;
+
+    // the shadow may hold the next period as well as the previous one
+    evolver_state_free(&evolver->ctx, evolver_shadow(evolver, current));
+
+    gmp_randclear(evolver->ctx.prng);
+
+    pthread_mutex_destroy(&evolver->lock);
+    pthread_cond_destroy(&evolver->changed);
+
+    free(evolver);
+
+    return players;
+}
+
+player_t *evolver_acquire(evolver_t *evolver)
+{
+    for (;;)
+    {
+        evolver_state_t *state = atomic_load(&evolver->current);
+
+        atomic_fetch_add(&state->readers, 1);
+
+        // the state may have been swapped out before the pin: the worker could be rewriting it
+        if (state == atomic_load(&evolver->current))
+            return state->players;
+
+        evolver_release(evolver, state->players);
+    }
+}
+
+void evolver_release(evolver_t *evolver, player_t *players)
+{
+    evolver_state_t *state = players == evolver->states[0].players ? &evolver->states[0] : &evolver->states[1];
+
+    // only the last signer of a swapped out state has to wipe it
+    if (atomic_fetch_sub(&state->readers, 1) == 1 && state != atomic_load(&evolver->current))
+    {
+        pthread_mutex_lock(&evolver->lock);
+        evolver_retire(evolver, state);
+        pthread_mutex_unlock(&evolver->lock);
+    }
+}
+
+uint8_t evolver_advance(evolver_t *evolver)
+{
+    pthread_mutex_lock(&evolver->lock);
+
+    while (!evolver->ready && evolver->stale)
+        pthread_cond_wait(&evolver->changed, &evolver->lock);
+
+    uint8_t res = evolver->ready;
+
+    if (res)
+    {
+        evolver_state_t *old = atomic_load(&evolver->current);
+
+        atomic_store(&evolver->current, evolver_shadow(evolver, old));
+
+        evolver->ready = 0;
+        evolver->stale = 1;
+        evolver->retired = 1;
+        evolver->transitions++;
+
+        evolver_retire(evolver, old);
+
+        pthread_cond_broadcast(&evolver->changed);
+    }
+
+    pthread_mutex_unlock(&evolver->lock);
+
+    return res;
+}
+
+signature_t *evolver_sign(evolver_t *evolver, context_t *ctx, const char *m)
+{
+    player_t *players = evolver_acquire(evolver);
+
+#ifdef USE_POLYNOMIAL
+    signature_t *signature = sign_packed(ctx, evolver->pk, players, m, players[0].sk.j);
+#else
+    signature_t *signature = sign(ctx, evolver->pk, players, m, players[0].sk.j);
+#endif
+
+    evolver_release(evolver, players);
+
+    return signature;
+}
@@ -0,0 +1,214 @@
+#include "../include/fixed-limb.h"
+#include "../include/utils.h"
+
+/**
+ * @brief Montgomery reduction of the 2n limbs of `t` into n limbs of `dst`.
+ *
+ * Each step clears the lowest limb of `t` by adding a multiple of N and parks the carry of that
+ * addition in the cleared limb; the parked carries are added back in a single pass at the end.
+ */
+#define FIXED_LIMB_DEFINE(n)                                                                                                \
+    static inline void fixed_limb_redc_##n(const mp_limb_t *N, mp_limb_t ninv, mp_limb_t *dst, mp_limb_t *t)                \
+    {                                                                                                                       \
+        for (uint32_t i = 0; i < n; i++)                                                                                    \
+        {                                                                                                                   \
+            t[i] = mpn_addmul_1(t + i, N, n, t[i] * ninv);                                                                  \
+        }                                                                                                                   \
+                                                                                                                            \
+        if (mpn_add_n(dst, t + n, t, n) != 0)                                                                               \
+            mpn_sub_n(dst, dst, N, n);                                                                                      \
+    }                                                                                                                       \
+                                                                                                                            \
+    static void fixed_limb_mul_##n(const mp_limb_t *N, mp_limb_t ninv, mp_limb_t *dst, const mp_limb_t *a, const mp_limb_t *b, \
+                                   mp_limb_t *scratch)                                                                      \
+    {                                                                                                                       \
+        mpn_mul_n(scratch, a, b, n);                                                                                        \
+        fixed_limb_redc_##n(N, ninv, dst, scratch);                                                                         \
+    }                                                                                                                       \
+                                                                                                                            \
+    static void fixed_limb_sqr_##n(const mp_limb_t *N, mp_limb_t ninv, mp_limb_t *dst, const mp_limb_t *a, mp_limb_t *scratch) \
+    {                                                                                                                       \
+        mpn_sqr(scratch, a, n);                                                                                             \
+        fixed_limb_redc_##n(N, ninv, dst, scratch);                                                                         \
+    }
+
+FIXED_LIMB_DEFINE(16)
+FIXED_LIMB_DEFINE(32)
+FIXED_LIMB_DEFINE(48)
+FIXED_LIMB_DEFINE(64)
+
+static __thread fixed_limb_t fixed_limb_cache;
+
+fixed_limb_t *fixed_limb_get(const mpz_t N)
+{
+    fixed_limb_t *f = &fixed_limb_cache;
+    uint32_t size = mpz_size(N);
+
+    if (mpz_sgn(N) <= 0 || mpz_even_p(N))
+        return NULL;
+
+    if (f->size == size && mpn_cmp(f->N, mpz_limbs_read(N), size) == 0)
+        return f;
+
+    switch (size)
+    {
+    case 16:
+        f->mul = fixed_limb_mul_16;
+        f->sqr = fixed_limb_sqr_16;
+        break;
+    case 32:
+        f->mul = fixed_limb_mul_32;
+        f->sqr = fixed_limb_sqr_32;
+        break;
+    case 48:
+        f->mul = fixed_limb_mul_48;
+        f->sqr = fixed_limb_sqr_48;
+        break;
+    case 64:
+        f->mul = fixed_limb_mul_64;
+        f->sqr = fixed_limb_sqr_64;
+        break;
+    default:
+        return NULL;
+    }
+
+    f->size = size;
+    mpn_copyi(f->N, mpz_limbs_read(N), size);
+
+    // Newton iteration for 1/N mod B, every step doubles the correct low bits
+    mp_limb_t inverse = f->N[0];
+
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        inverse *= 2 - f->N[0] * inverse;
+    }
+
+    f->ninv = -inverse;
+
+    mpz_t power;
+    mpz_init(power);
+
+    mpz_setbit(power, 2 * size * GMP_NUMB_BITS);
+    mpz_mod(power, power, N);
+    mpn_zero(f->R2, size);
+    mpn_copyi(f->R2, mpz_limbs_read(power), mpz_size(power));
+
+    mpz_clear(power);
+
+    return f;
+}
+
+static inline uint8_t fixed_limb_fits(const fixed_limb_t *f, const mpz_t x)
+{
+    return mpz_sgn(x) >= 0 && mpz_size(x) <= f->size;
+}
+
+// dst = x * B^size mod N
+static void fixed_limb_to(fixed_limb_t *f, mp_limb_t *dst, const mpz_t x)
+{
+    mpn_zero(dst, f->size);
+    mpn_copyi(dst, mpz_limbs_read(x), mpz_size(x));
+
+    f->mul(f->N, f->ninv, dst, dst, f->R2, f->scratch);
+}
+
+// dst = x / B^size mod N, fully reduced
+static void fixed_limb_from(fixed_limb_t *f, mpz_t dst, const mp_limb_t *x)
+{
+    mp_limb_t unit[FIXED_LIMB_MAX] = {1};
+
+    mp_limb_t *limbs = mpz_limbs_write(dst, f->size);
+
+    // the Montgomery product by a plain 1 is at most N
+    f->mul(f->N, f->ninv, limbs, x, unit, f->scratch);
+
+    if (mpn_cmp(limbs, f->N, f->size) >= 0)
+        mpn_sub_n(limbs, limbs, f->N, f->size);
+
+    mpz_limbs_finish(dst, f->size);
+}
+
+uint8_t fixed_limb_double_pow(mpz_t dst, uint32_t squarings, const mpz_t N)
+{
+    return fixed_limb_double_pow_batch((mpz_t *)dst, 1, squarings, N);
+}
+
+uint8_t fixed_limb_double_pow_batch(mpz_t *values, uint32_t count, uint32_t squarings, const mpz_t N)
+{
+    fixed_limb_t *f = fixed_limb_get(N);
+    mp_limb_t x[FIXED_LIMB_MAX];
+
+    if (f == NULL)
+        return 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!fixed_limb_fits(f, values[i]))
+            return 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        fixed_limb_to(f, x, values[i]);
+
+        for (uint32_t s = 0; s < squarings; s++)
+        {
+            f->sqr(f->N, f->ninv, x, x, f->scratch);
+        }
+
+        fixed_limb_from(f, values[i], x);
+    }
+
+    return 1;
+}
+
+uint8_t fixed_limb_mmul_pow_array(mpz_t dst, const mpz_t base, const uint8_t *c, const mpz_t *key, uint32_t l, const mpz_t N)
+{
+    fixed_limb_t *f = fixed_limb_get(N);
+    mp_limb_t x[FIXED_LIMB_MAX], k[FIXED_LIMB_MAX], correction[FIXED_LIMB_MAX], power[FIXED_LIMB_MAX];
+    uint32_t m = 0;
+
+    if (f == NULL || !fixed_limb_fits(f, base))
+        return 0;
+
+    for (uint32_t i = 0; i < l; i++)
+    {
+        if (c[i] != 0 && !fixed_limb_fits(f, key[i]))
+            return 0;
+    }
+
+    // the keys are multiplied in as they are: every product leaves a factor 1/B^size behind
+    mpn_zero(x, f->size);
+    mpn_copyi(x, mpz_limbs_read(base), mpz_size(base));
+
+    for (uint32_t i = 0; i < l; i++)
+    {
+        if (c[i] == 0)
+            continue;
+
+        mpn_zero(k, f->size);
+        mpn_copyi(k, mpz_limbs_read(key[i]), mpz_size(key[i]));
+
+        f->mul(f->N, f->ninv, x, x, k, f->scratch);
+        m++;
+    }
+
+    // a last product by B^(size * (m + 2)) cancels them and leaves the result in Montgomery form.
+    // The Montgomery product of B^(size * (a + 1)) and B^(size * (b + 1)) is B^(size * (a + b + 1)),
+    // so starting from R2 (a = 1) it is reached by square-and-multiply on the exponent m
+    mpn_copyi(correction, f->R2, f->size);
+    mpn_copyi(power, f->R2, f->size);
+
+    for (; m > 0; m >>= 1)
+    {
+        if (m & 1)
+            f->mul(f->N, f->ninv, correction, correction, power, f->scratch);
+
+        f->sqr(f->N, f->ninv, power, power, f->scratch);
+    }
+
+    f->mul(f->N, f->ninv, x, x, correction, f->scratch);
+    fixed_limb_from(f, dst, x);
+
+    return 1;
+}
@@ -0,0 +1,63 @@
+#include "../include/key-store.h"
+#include "../include/utils.h"
+
+key_store_t *key_store_new(uint32_t count, const mpz_t N)
+{
+    const uint32_t line = KEY_STORE_ALIGNMENT / sizeof(mp_limb_t);
+
+    key_store_t *store = (key_store_t *)malloc(sizeof(key_store_t));
+    check_null_pointer(store);
+
+    store->count = count;
+    store->stride = (mpz_size(N) + 1 + line - 1) / line * line;
+
+    store->limbs = (mp_limb_t *)aligned_alloc(KEY_STORE_ALIGNMENT, (size_t)count * store->stride * sizeof(mp_limb_t));
+    check_null_pointer(store->limbs);
+
+    store->views = (mpz_t *)malloc(count * sizeof(mpz_t));
+    check_null_pointer(store->views);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        store->views[i]->_mp_d = store->limbs + (size_t)i * store->stride;
+        store->views[i]->_mp_alloc = store->stride;
+        store->views[i]->_mp_size = 0;
+    }
+
+    return store;
+}
+
+void key_store_free(key_store_t *store)
+{
+    key_store_wipe(store);
+
+    free(store->limbs);
+    free(store->views);
+    free(store);
+}
+
+void key_store_wipe(key_store_t *store)
+{
+    memset(store->limbs, 0, (size_t)store->count * store->stride * sizeof(mp_limb_t));
+
+    for (uint32_t i = 0; i < store->count; i++)
+    {
+        store->views[i]->_mp_size = 0;
+    }
+}
+
+uint8_t key_store_copy(key_store_t *dst, const key_store_t *src)
+{
+    if (dst->count != src->count || dst->stride != src->stride)
+        return 0;
+
+    // the limbs past the size of a view are zero or stale, the whole slab is copied anyway
+    memcpy(dst->limbs, src->limbs, (size_t)src->count * src->stride * sizeof(mp_limb_t));
+
+    for (uint32_t i = 0; i < src->count; i++)
+    {
+        dst->views[i]->_mp_size = src->views[i]->_mp_size;
+    }
+
+    return 1;
+}
@@ -16,13 +16,188 @@ void keygen(context_t *ctx, public_key_t *pk, player_t *players)
         {
             dealer_set_player_private_key_i(ctx, players[j].sk, i);
         }
+    }
+
+    // the public key is the product of the per-player verification keys
+    dealer_multiplicative_init_verification_keys(ctx, pk, players);
 
-        dealer_multiplicative_compute_public_key_i(ctx, pk, players, i);
+    for (uint32_t i = 0; i < ctx->l; i++)
+    {
+        dealer_multiplicative_combine_public_key_i(ctx, pk, pk->verification, i);
     }
 }
 
-signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j)
+typedef struct
+{
+    context_t *ctx;
+    public_key_t *pk;
+    player_t *players;
+    key_store_t *partials;
+    gmp_randstate_t *prngs;
+    uint32_t chunks;
+} keygen_distributed_job_t;
+
+static void keygen_distributed_player(uint32_t idx, void *arg)
+{
+    keygen_distributed_job_t *job = (keygen_distributed_job_t *)arg;
+
+    player_multiplicative_compute_partials(job->ctx, job->pk, &job->players[idx], key_store_views(job->partials, idx * job->ctx->l), job->prngs[idx]);
+}
+
+static void keygen_distributed_combine(uint32_t idx, void *arg)
+{
+    keygen_distributed_job_t *job = (keygen_distributed_job_t *)arg;
+
+    uint32_t first = idx * job->ctx->l / job->chunks;
+    uint32_t last = (idx + 1) * job->ctx->l / job->chunks;
+
+    for (uint32_t i = first; i < last; i++)
+    {
+        dealer_multiplicative_combine_public_key_i(job->ctx, job->pk, job->partials, i);
+    }
+}
+
+void keygen_distributed(context_t *ctx, public_key_t *pk, player_t *players)
+{
+    dealer_init_modulo(ctx, pk);
+
+    dealer_init_players(ctx, pk, players);
+
+    dealer_init_pk(ctx, pk);
+
+    keygen_distributed_job_t job = {ctx, pk, players, key_store_new(ctx->n * ctx->l, pk->N), NULL, parallel_threads()};
+
+    if (job.chunks > ctx->l)
+    {
+        job.chunks = ctx->l;
+    }
+
+    // each player draws from its own random state
+    job.prngs = (gmp_randstate_t *)malloc(ctx->n * sizeof(gmp_randstate_t));
+    check_null_pointer(job.prngs);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        gmp_randinit_derived(job.prngs[i], ctx->prng);
+    }
+
+    parallel_for(ctx->n, keygen_distributed_player, &job);
+
+    parallel_for(job.chunks, keygen_distributed_combine, &job);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        gmp_randclear(job.prngs[i]);
+    }
+
+    free(job.prngs);
+
+    // the published partials are the per-player verification keys
+    pk->verification = job.partials;
+    pk->V = key_store_views(pk->verification, 0);
+}
+
+provision_t *keygen_seeded(context_t *ctx, public_key_t *pk, player_t *players)
+{
+    dealer_init_modulo(ctx, pk);
+
+    dealer_init_players(ctx, pk, players);
+
+    dealer_init_pk(ctx, pk);
+
+    provision_t *provision = provision_new(ctx, ctx->n, pk->N);
+
+    // the dealer expands the same seeds to compute the public key
+    for (uint32_t j = 0; j < ctx->n; j++)
+    {
+        provision_expand(provision, j, players[j].sk.S, pk->N);
+    }
+
+    dealer_multiplicative_init_verification_keys(ctx, pk, players);
+
+    for (uint32_t i = 0; i < ctx->l; i++)
+    {
+        dealer_multiplicative_combine_public_key_i(ctx, pk, pk->verification, i);
+    }
+
+    return provision;
+}
+
+typedef struct
+{
+    context_t *ctx;
+    public_key_t *pk;
+    const uint8_t *c;
+    mpz_t *y_players;
+    mpz_t *powers;
+    uint8_t *valid;
+    uint32_t chunks;
+} verify_partials_job_t;
+
+static void verify_partials_chunk(uint32_t idx, void *arg)
+{
+    verify_partials_job_t *job = (verify_partials_job_t *)arg;
+
+    uint32_t first = idx * job->ctx->n / job->chunks;
+    uint32_t last = (idx + 1) * job->ctx->n / job->chunks;
+
+    mpz_t right;
+    mpz_init(right);
+
+    for (uint32_t p = first; p < last; p++)
+    {
+        mpz_mmul_pow_array(right, job->y_players[p], job->c, job->pk->V + p * job->ctx->l, job->ctx->l, job->pk->N);
+
+        job->valid[p] = mpz_cmp(right, job->powers[p]) == 0;
+    }
+
+    mpz_clear(right);
+}
+
+uint32_t verify_partials(context_t *ctx, public_key_t *pk, const uint8_t *c, uint32_t j, mpz_t *y_players, mpz_t *z_players, uint8_t *valid)
+{
+    verify_partials_job_t job = {ctx, pk, c, y_players, NULL, valid, parallel_threads()};
+    uint32_t count = 0;
+
+    if (job.chunks > ctx->n)
+    {
+        job.chunks = ctx->n;
+    }
+
+    job.powers = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(job.powers);
+
+    for (uint32_t p = 0; p < ctx->n; p++)
+    {
+        mpz_init_set(job.powers[p], z_players[p]);
+    }
+
+    // the players' chains are independent: square them side by side
+    mpz_double_pow_batch(job.powers, ctx->n, ctx->T, j, pk->N);
+
+    parallel_for(job.chunks, verify_partials_chunk, &job);
+
+    for (uint32_t p = 0; p < ctx->n; p++)
+    {
+        count += valid[p];
+        mpz_clear(job.powers[p]);
+    }
+
+    free(job.powers);
+
+    return count;
+}
+
+/**
+ * @brief Runs a signing round, checking the contributions when `faulty` is not NULL.
+ *
+ * The combined signature is verified first; only when it fails the contributions are checked
+ * with `verify_partials`, and each faulty player computes its z again from the same r.
+ */
+static signature_t *sign_round(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j, uint8_t *faulty)
 {
+    arena_scope_begin();
+
     mpz_t *r_players = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
     check_null_pointer(r_players);
 
@@ -38,9 +213,12 @@ signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const cha
     for (uint32_t i = 0; i < ctx->n; i++)
     {
         player_multiplicative_compute_r(ctx, pk, &r_players[i]);
-        player_multiplicative_compute_y(ctx, pk, &y_players[i], r_players[i], j);
+        mpz_init_set(y_players[i], r_players[i]);
     }
 
+    // the players' chains are independent: square them side by side
+    mpz_double_pow_batch(y_players, ctx->n, ctx->T, j, pk->N);
+
     mpz_mmul_array(y, y_players, ctx->n, pk->N);
 
     uint8_t *c = player_compute_c(ctx, y, j, m);
@@ -52,66 +230,400 @@ signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const cha
 
     mpz_mmul_array(z, z_players, ctx->n, pk->N);
 
+    uint8_t valid = 1;
+
+    if (faulty != NULL)
+    {
+        signature_t candidate;
+
+        candidate.j = j;
+        mpz_init_set(candidate.y, y);
+        mpz_init_set(candidate.z, z);
+
+        memset(faulty, 0, ctx->n);
+
+        if (verify(ctx, pk, m, &candidate) == 0)
+        {
+            // the faulty players are known at once: they retry their z, the others are not
+            // involved. Until the end `faulty` holds the flags of the valid contributions
+            if (verify_partials(ctx, pk, c, j, y_players, z_players, faulty) < ctx->n)
+            {
+                for (uint32_t i = 0; i < ctx->n; i++)
+                {
+                    if (faulty[i])
+                        continue;
+
+                    mpz_clear(z_players[i]);
+                    player_multiplicative_compute_z(ctx, pk, &z_players[i], r_players[i], players[i].sk.S, c);
+                }
+
+                valid = verify_partials(ctx, pk, c, j, y_players, z_players, faulty) == ctx->n;
+            }
+
+            for (uint32_t i = 0; i < ctx->n; i++)
+            {
+                faulty[i] = !faulty[i];
+            }
+
+            mpz_mmul_array(z, z_players, ctx->n, pk->N);
+        }
+
+        mpz_clears(candidate.y, candidate.z, NULL);
+    }
+
     for (uint32_t i = 0; i < ctx->n; i++)
     {
         mpz_clears(r_players[i], y_players[i], z_players[i], NULL);
     }
 
+    free(r_players);
+    free(y_players);
+    free(z_players);
     free(c);
 
-    signature_t *signature = signature_malloc(y, z, j);
+    signature_t *signature = NULL;
+
+    if (valid)
+    {
+        arena_scope_suspend();
+        signature = signature_malloc(y, z, j);
+        arena_scope_resume();
+    }
 
     mpz_clears(y, z, NULL);
 
+    arena_scope_end();
+
     return signature;
 }
 
-uint8_t update(context_t *ctx, public_key_t *pk, player_t *players, uint32_t j)
+signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j)
 {
-    if (j >= ctx->T)
+    return sign_round(ctx, pk, players, m, j, NULL);
+}
+
+signature_t *sign_checked(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j, uint8_t *faulty)
+{
+    return sign_round(ctx, pk, players, m, j, faulty);
+}
+
+void sign_batch(context_t *ctx, public_key_t *pk, player_t *players, const char **msgs, uint32_t count, uint32_t j, signature_t *out)
+{
+    arena_scope_begin();
+
+    // nonce of player i for message k at [i * count + k]
+    mpz_t *r = (mpz_t *)malloc(ctx->n * count * sizeof(mpz_t));
+    check_null_pointer(r);
+
+    mpz_t *y = (mpz_t *)malloc(ctx->n * count * sizeof(mpz_t));
+    check_null_pointer(y);
+
+    mpz_t *Y = (mpz_t *)malloc(count * sizeof(mpz_t));
+    check_null_pointer(Y);
+
+    mpz_t *Z = (mpz_t *)malloc(count * sizeof(mpz_t));
+    check_null_pointer(Z);
+
+    uint8_t *c = (uint8_t *)malloc(count * ctx->l * sizeof(uint8_t));
+    check_null_pointer(c);
+
+    mpz_t z;
+    mpz_init(z);
+
+    for (uint32_t i = 0; i < ctx->n * count; i++)
     {
-        return 0;
+        mpz_init(r[i]);
+        mpz_set_random_n_coprime(r[i], pk->N, ctx->prng);
+        mpz_init_set(y[i], r[i]);
+    }
+
+    mpz_double_pow_batch(y, ctx->n * count, ctx->T, j, pk->N);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        mpz_init_set(Y[k], y[k]);
+
+        for (uint32_t i = 1; i < ctx->n; i++)
+        {
+            mpz_mul(Y[k], Y[k], y[i * count + k]);
+            mpz_mod(Y[k], Y[k], pk->N);
+        }
+    }
+
+    players_compute_c_batch(ctx, c, (const mpz_t *)Y, j, msgs, count);
+
+    // every player multiplies the same l shares into each z: for large enough batches the
+    // products of each window of shares are tabulated once per player and each z takes one
+    // product per window
+    uint32_t window = count >= SIGN_BATCH_WIDE_WINDOW_COUNT ? SIGN_BATCH_WIDE_WINDOW : SIGN_BATCH_WINDOW;
+
+    if (count < SIGN_BATCH_WINDOW_COUNT)
+        window = 0;
+
+    uint32_t windows = window ? (ctx->l + window - 1) / window : 0;
+    uint32_t entries = 1 << window;
+
+    mpz_t *table = (mpz_t *)malloc(windows * entries * sizeof(mpz_t));
+    check_null_pointer(table);
+
+    for (uint32_t w = 0; w < windows * entries; w++)
+    {
+        mpz_init(table[w]);
+    }
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        mpz_init_set_ui(Z[k], 1);
     }
 
     for (uint32_t i = 0; i < ctx->n; i++)
     {
-        for (uint32_t j = 0; j < ctx->l; j++)
+        for (uint32_t w = 0; w < windows; w++)
+        {
+            mpz_t *products = table + w * entries;
+
+            mpz_set_ui(products[0], 1);
+
+            for (uint32_t mask = 1; mask < entries; mask++)
+            {
+                uint32_t bit = __builtin_ctz(mask);
+                uint32_t idx = w * window + bit;
+
+                if (idx < ctx->l)
+                {
+                    mpz_mul(products[mask], products[mask & (mask - 1)], players[i].sk.S[idx]);
+                    mpz_mod(products[mask], products[mask], pk->N);
+                }
+                else
+                {
+                    mpz_set(products[mask], products[mask & (mask - 1)]);
+                }
+            }
+        }
+
+        for (uint32_t k = 0; k < count; k++)
         {
-            mpz_powm_ui(players[i].sk.S[j], players[i].sk.S[j], 2, pk->N);
+            const uint8_t *bits = c + k * ctx->l;
+
+            if (window == 0)
+                mpz_mmul_pow_array(z, r[i * count + k], bits, (const mpz_t *)players[i].sk.S, ctx->l, pk->N);
+            else
+                mpz_set(z, r[i * count + k]);
+
+            for (uint32_t w = 0; w < windows; w++)
+            {
+                uint32_t mask = 0;
+
+                for (uint32_t b = 0; b < window && w * window + b < ctx->l; b++)
+                {
+                    mask |= (uint32_t)bits[w * window + b] << b;
+                }
+
+                if (mask == 0)
+                    continue;
+
+                mpz_mul(z, z, table[w * entries + mask]);
+                mpz_mod(z, z, pk->N);
+            }
+
+            mpz_mul(Z[k], Z[k], z);
+            mpz_mod(Z[k], Z[k], pk->N);
         }
+    }
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        arena_scope_suspend();
+        mpz_init_set(out[k].y, Y[k]);
+        mpz_init_set(out[k].z, Z[k]);
+        out[k].j = j;
+        arena_scope_resume();
+
+        mpz_clear(Z[k]);
+    }
+
+    for (uint32_t w = 0; w < windows * entries; w++)
+    {
+        mpz_clear(table[w]);
+    }
+
+    free(table);
+
+    for (uint32_t i = 0; i < ctx->n * count; i++)
+    {
+        mpz_clears(r[i], y[i], NULL);
+    }
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        mpz_clear(Y[k]);
+    }
 
+    free(r);
+    free(y);
+    free(Y);
+    free(Z);
+    free(c);
+
+    mpz_clear(z);
+
+    arena_scope_end();
+}
+
+signature_t *sign_quorum(context_t *ctx, public_key_t *pk, player_t *players, const quorum_t *quorum, const char *m, uint32_t j)
+{
+    // the key is split as a product of n shares: every player has to take part
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        if (!quorum_has(quorum, i))
+            return NULL;
+    }
+
+    if (quorum_size(quorum) != ctx->n)
+        return NULL;
+
+    return sign(ctx, pk, players, m, j);
+}
+
+uint8_t update(context_t *ctx, public_key_t *pk, player_t *players, uint32_t j)
+{
+    if (j >= ctx->T)
+    {
+        return 0;
+    }
+
+    arena_scope_begin();
+
+    // the n * l squarings are independent and the shares stay reduced: they go through
+    // mpz_square_batch in one batch, in place in the key store
+    mpz_square_batch(key_store_views(players[0].sk.store, 0), ctx->n * ctx->l, 1, pk->N);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
         players[i].sk.j++;
     }
 
+    arena_scope_end();
+
     return 1;
 }
 
-void refresh(context_t *ctx, public_key_t *pk, player_t *players)
+typedef struct
 {
-    mpz_t **players_random_shares = (mpz_t **)malloc(ctx->n * sizeof(mpz_t *));
-    check_null_pointer(players_random_shares);
+    context_t *ctx;
+    public_key_t *pk;
+    player_t *players;
+    uint32_t squarings;
+    uint32_t chunk;
+} update_to_job_t;
 
-    for (uint32_t i = 0; i < ctx->n; i++)
+static void update_to_secrets(uint32_t idx, void *arg)
+{
+    update_to_job_t *job = (update_to_job_t *)arg;
+    uint32_t first = idx * job->chunk;
+    uint32_t count = job->ctx->n * job->ctx->l - first;
+
+    if (count > job->chunk)
+        count = job->chunk;
+
+    arena_scope_begin();
+
+    // S^(2^d) is a chain of d squarings, independent for every secret
+    mpz_square_batch(key_store_views(job->players[0].sk.store, first), count, job->squarings, job->pk->N);
+
+    arena_scope_end();
+}
+
+uint8_t update_to(context_t *ctx, public_key_t *pk, player_t *players, uint32_t target_period)
+{
+    if (target_period > ctx->T || target_period < players[0].sk.j)
     {
-        players_random_shares[i] = player_get_random_product_congruent_one(ctx, pk);
+        return 0;
     }
 
-    for (uint32_t j = 0; j < ctx->n; j++)
+    uint32_t total = ctx->n * ctx->l;
+
+    // one chunk of secrets per thread, in whole groups of SIMD lanes
+    uint32_t chunk = (total + parallel_threads() - 1) / parallel_threads();
+    chunk = (chunk + SIMD_MONT_MAX_LANES - 1) / SIMD_MONT_MAX_LANES * SIMD_MONT_MAX_LANES;
+
+    update_to_job_t job = {ctx, pk, players, target_period - players[0].sk.j, chunk};
+
+    parallel_for((total + chunk - 1) / chunk, update_to_secrets, &job);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
     {
-        player_multiplicative_compute_new_secret_share(ctx, pk, players, players_random_shares, j);
+        players[i].sk.j = target_period;
     }
 
+    return 1;
+}
+
+uint8_t refresh(context_t *ctx, public_key_t *pk, player_t *players)
+{
+    arena_scope_begin();
+
+    // each sender i draws n - 1 random values and sends the inverse of their product as the last
+    // one: only the running products of the rows and of the columns are kept, the n x n matrix
+    // is never built
+    mpz_t *row_products = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(row_products);
+
+    mpz_t *column_products = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(column_products);
+
+    mpz_t *column = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(column);
+
     for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_init_set_ui(row_products[i], 1);
+        mpz_init_set_ui(column_products[i], 1);
+        mpz_init(column[i]);
+    }
+
+    // column j collects the values received by player j
+    for (uint32_t j = 0; j < ctx->n - 1; j++)
+    {
+        mpz_urandomm_array(column, ctx->n, ctx->prng, pk->N);
+
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            mpz_mul(row_products[i], row_products[i], column[i]);
+            mpz_mod(row_products[i], row_products[i], pk->N);
+
+            mpz_mul(column_products[j], column_products[j], column[i]);
+            mpz_mod(column_products[j], column_products[j], pk->N);
+        }
+    }
+
+    // the last column holds the inverses of the rows: its product is the inverse of them all
+    mpz_mmul_array(column_products[ctx->n - 1], row_products, ctx->n, pk->N);
+
+    uint8_t res = mpz_invert(column_products[ctx->n - 1], column_products[ctx->n - 1], pk->N) != 0;
+
+    // a value sharing a factor with N leaves the shares untouched
+    if (res)
     {
         for (uint32_t j = 0; j < ctx->n; j++)
         {
-            mpz_clear(players_random_shares[i][j]);
+            player_multiplicative_compute_new_secret_share(ctx, pk, &players[j], column_products[j]);
+            player_multiplicative_compute_new_verification_keys(ctx, pk, &players[j], column_products[j]);
         }
+    }
 
-        free(players_random_shares[i]);
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_clears(row_products[i], column_products[i], column[i], NULL);
     }
 
-    free(players_random_shares);
+    free(row_products);
+    free(column_products);
+    free(column);
+
+    arena_scope_end();
+
+    return res;
 }
 
 #endif
\ No newline at end of file
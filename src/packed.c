@@ -0,0 +1,339 @@
+#include "../include/packed.h"
+#include "../include/utils.h"
+
+static __thread packed_t packed_cache;
+
+static void packed_entry_clear(packed_t *p)
+{
+    for (uint32_t i = 0; i < p->n * p->factor; i++)
+    {
+        mpz_clear(p->basis[i]);
+    }
+
+    for (uint32_t i = 0; i < p->n; i++)
+    {
+        mpz_clear(p->vanishing[i]);
+    }
+
+    for (uint32_t i = 0; i < p->factor * p->width; i++)
+    {
+        mpz_clear(p->open[i]);
+    }
+
+    free(p->basis);
+    free(p->vanishing);
+    free(p->open);
+
+    mpz_clear(p->N);
+
+    p->factor = 0;
+}
+
+static void packed_entry_fill(packed_t *p, uint32_t n, uint32_t threshold, uint32_t factor, const mpz_t N)
+{
+    p->n = n;
+    p->threshold = threshold;
+    p->factor = factor;
+    p->degree = threshold + factor - 2;
+    p->width = 2 * p->degree + 1;
+
+    mpz_init_set(p->N, N);
+
+    p->basis = (mpz_t *)malloc(n * factor * sizeof(mpz_t));
+    check_null_pointer(p->basis);
+
+    p->vanishing = (mpz_t *)malloc(n * sizeof(mpz_t));
+    check_null_pointer(p->vanishing);
+
+    p->open = (mpz_t *)malloc(factor * p->width * sizeof(mpz_t));
+    check_null_pointer(p->open);
+
+    mpz_point_t *slots = (mpz_point_t *)malloc(factor * sizeof(mpz_point_t));
+    check_null_pointer(slots);
+
+    mpz_point_t *abscissas = (mpz_point_t *)malloc(p->width * sizeof(mpz_point_t));
+    check_null_pointer(abscissas);
+
+    mpz_t point;
+    mpz_init(point);
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        mpz_init_set_si(slots[s].x, -(long)s - 1);
+        mpz_init(slots[s].y);
+    }
+
+    for (uint32_t i = 0; i < p->width; i++)
+    {
+        mpz_init_set_ui(abscissas[i].x, i + 1);
+        mpz_init(abscissas[i].y);
+    }
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        mpz_t *row = p->basis + k * factor;
+
+        for (uint32_t s = 0; s < factor; s++)
+        {
+            mpz_init(row[s]);
+        }
+
+        mpz_set_ui(point, k + 1);
+        lagrange_coefficients_at(row, slots, point, factor, p->N);
+
+        mpz_init_set_ui(p->vanishing[k], 1);
+
+        for (uint32_t s = 0; s < factor; s++)
+        {
+            mpz_mul_ui(p->vanishing[k], p->vanishing[k], k + s + 2);
+        }
+    }
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        mpz_t *row = p->open + s * p->width;
+
+        for (uint32_t i = 0; i < p->width; i++)
+        {
+            mpz_init(row[i]);
+        }
+
+        lagrange_coefficients_at(row, abscissas, slots[s].x, p->width, p->N);
+    }
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        mpz_clear_point(slots[s]);
+    }
+
+    for (uint32_t i = 0; i < p->width; i++)
+    {
+        mpz_clear_point(abscissas[i]);
+    }
+
+    free(slots);
+    free(abscissas);
+
+    mpz_clear(point);
+}
+
+packed_t *packed_get(uint32_t n, uint32_t threshold, uint32_t factor, const mpz_t N)
+{
+    packed_t *p = &packed_cache;
+
+    if (!packed_fits(n, threshold, factor))
+        return NULL;
+
+    if (p->factor == factor && p->n == n && p->threshold == threshold && mpz_cmp(p->N, N) == 0)
+        return p;
+
+    // the coefficients outlive any arena scope
+    arena_scope_suspend();
+
+    if (p->factor != 0)
+        packed_entry_clear(p);
+
+    packed_entry_fill(p, n, threshold, factor, N);
+
+    arena_scope_resume();
+
+    return p;
+}
+
+void packed_cache_clear()
+{
+    arena_scope_suspend();
+
+    if (packed_cache.factor != 0)
+        packed_entry_clear(&packed_cache);
+
+    arena_scope_resume();
+}
+
+/**
+ * @brief Deals `count` slot values with a fresh rho, the remaining slots are zero.
+ *
+ * With `accumulate` the unreduced shares are added to `shares` instead: the sum of the packed
+ * sharings of several players is the packed sharing of the sum of their slots.
+ */
+static void packed_deal(packed_t *p, mpz_t *shares, const mpz_t *values, uint32_t count, mpz_t *rho, uint8_t accumulate, gmp_randstate_t prng)
+{
+    uint32_t coefficients = p->threshold - 1;
+
+    mpz_t evaluation, share;
+    mpz_inits(evaluation, share, NULL);
+
+    mpz_urandomm_array(rho, coefficients, prng, p->N);
+
+    for (uint32_t k = 0; k < p->n; k++)
+    {
+        const mpz_t *basis = (const mpz_t *)p->basis + k * p->factor;
+
+        // rho(k + 1) by Horner's method on small abscissas, then the small factor Z(k + 1)
+        mpz_set_ui(evaluation, 0);
+
+        for (int32_t j = coefficients - 1; j >= 0; j--)
+        {
+            mpz_mul_ui(evaluation, evaluation, k + 1);
+            mpz_add(evaluation, evaluation, rho[j]);
+        }
+
+        // the sum outgrows N, the share is only written reduced (it may be a key store view)
+        mpz_mul(share, evaluation, p->vanishing[k]);
+
+        for (uint32_t s = 0; s < count; s++)
+        {
+            mpz_addmul(share, basis[s], values[s]);
+        }
+
+        if (accumulate)
+            mpz_add(shares[k], shares[k], share);
+        else
+            mpz_mod(shares[k], share, p->N);
+    }
+
+    mpz_clears(evaluation, share, NULL);
+}
+
+void packed_share(packed_t *p, mpz_t *shares, const mpz_t *values, uint32_t count, gmp_randstate_t prng)
+{
+    mpz_t *rho = (mpz_t *)malloc(p->threshold * sizeof(mpz_t));
+    check_null_pointer(rho);
+
+    for (uint32_t i = 0; i < p->threshold; i++)
+    {
+        mpz_init(rho[i]);
+    }
+
+    packed_deal(p, shares, values, count, rho, 0, prng);
+
+    for (uint32_t i = 0; i < p->threshold; i++)
+    {
+        mpz_clear(rho[i]);
+    }
+
+    free(rho);
+}
+
+void packed_open(packed_t *p, mpz_t *values, const mpz_t *shares)
+{
+    for (uint32_t s = 0; s < p->factor; s++)
+    {
+        const mpz_t *row = (const mpz_t *)p->open + s * p->width;
+
+        mpz_set_ui(values[s], 0);
+
+        for (uint32_t i = 0; i < p->width; i++)
+        {
+            mpz_addmul(values[s], row[i], shares[i]);
+        }
+
+        mpz_mod(values[s], values[s], p->N);
+    }
+}
+
+void packed_unpack(packed_t *p, mpz_point_t *dst, const mpz_t *shares, uint32_t slot, gmp_randstate_t prng)
+{
+    const mpz_t *row = (const mpz_t *)p->open + slot * p->width;
+
+    mpz_t *secrets = (mpz_t *)malloc(p->n * sizeof(mpz_t));
+    check_null_pointer(secrets);
+
+    // the slot is a fixed linear combination of the first `width` shares: every player applies
+    // its own coefficient to its share and reshares the result, the others contribute zero
+    for (uint32_t i = 0; i < p->n; i++)
+    {
+        mpz_init(secrets[i]);
+
+        if (i < p->width)
+        {
+            mpz_mul(secrets[i], row[i], shares[i]);
+            mpz_mod(secrets[i], secrets[i], p->N);
+        }
+    }
+
+    joint_shamir_ss_at(dst, secrets, p->threshold, p->n, prng, p->N);
+
+    for (uint32_t i = 0; i < p->n; i++)
+    {
+        mpz_clear(secrets[i]);
+    }
+
+    free(secrets);
+}
+
+void packed_square(packed_t *p, mpz_t *shares, uint32_t rounds, gmp_randstate_t prng)
+{
+    mpz_t values[PACKED_MAX_FACTOR], square;
+    mpz_t *rho = (mpz_t *)malloc(p->threshold * sizeof(mpz_t));
+    check_null_pointer(rho);
+
+    mpz_t *sums = (mpz_t *)malloc(p->n * sizeof(mpz_t));
+    check_null_pointer(sums);
+
+    mpz_init(square);
+
+    for (uint32_t k = 0; k < p->n; k++)
+    {
+        mpz_init(sums[k]);
+    }
+
+    for (uint32_t s = 0; s < p->factor; s++)
+    {
+        mpz_init(values[s]);
+    }
+
+    for (uint32_t i = 0; i < p->threshold; i++)
+    {
+        mpz_init(rho[i]);
+    }
+
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        for (uint32_t k = 0; k < p->n; k++)
+        {
+            mpz_set_ui(sums[k], 0);
+        }
+
+        // every slot of the squared pack is a linear combination of the first `width` squared
+        // shares: each of those players deals a pack of its own terms, the players add them up
+        for (uint32_t i = 0; i < p->width; i++)
+        {
+            mpz_mul(square, shares[i], shares[i]);
+            mpz_mod(square, square, p->N);
+
+            for (uint32_t s = 0; s < p->factor; s++)
+            {
+                mpz_mul(values[s], p->open[s * p->width + i], square);
+                mpz_mod(values[s], values[s], p->N);
+            }
+
+            packed_deal(p, sums, (const mpz_t *)values, p->factor, rho, 1, prng);
+        }
+
+        for (uint32_t k = 0; k < p->n; k++)
+        {
+            mpz_mod(shares[k], sums[k], p->N);
+        }
+    }
+
+    for (uint32_t s = 0; s < p->factor; s++)
+    {
+        mpz_clear(values[s]);
+    }
+
+    for (uint32_t i = 0; i < p->threshold; i++)
+    {
+        mpz_clear(rho[i]);
+    }
+
+    for (uint32_t k = 0; k < p->n; k++)
+    {
+        mpz_clear(sums[k]);
+    }
+
+    free(rho);
+    free(sums);
+
+    mpz_clear(square);
+}
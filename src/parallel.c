@@ -0,0 +1,142 @@
+#include "../include/parallel.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <unistd.h>
+
+typedef struct
+{
+    parallel_body_t body;
+    void *arg;
+    uint32_t count;
+    uint32_t next;
+    uint32_t completed;
+    uint32_t active;
+} parallel_job_t;
+
+static struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+
+    uint32_t workers;
+    uint64_t generation;
+    parallel_job_t *job;
+} pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+static pthread_mutex_t pool_submit = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+static __thread int parallel_nested;
+
+static void parallel_run(parallel_job_t *job)
+{
+    uint32_t i;
+
+    while ((i = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->count)
+    {
+        job->body(i, job->arg);
+        __atomic_add_fetch(&job->completed, 1, __ATOMIC_RELEASE);
+    }
+}
+
+static void *parallel_worker(void *unused)
+{
+    uint64_t seen = 0;
+
+    parallel_nested = 1;
+
+    pthread_mutex_lock(&pool.lock);
+
+    for (;;)
+    {
+        while (pool.generation == seen)
+            pthread_cond_wait(&pool.start, &pool.lock);
+
+        seen = pool.generation;
+
+        // the job may already be over if this worker woke up late
+        parallel_job_t *job = pool.job;
+
+        if (job == NULL)
+            continue;
+
+        job->active++;
+
+        pthread_mutex_unlock(&pool.lock);
+
+        parallel_run(job);
+
+        pthread_mutex_lock(&pool.lock);
+
+        if (--job->active == 0)
+            pthread_cond_broadcast(&pool.done);
+    }
+
+    return NULL;
+}
+
+static void parallel_start_pool()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t workers = cpus > 1 ? (uint32_t)cpus - 1 : 0;
+
+    if (workers > PARALLEL_MAX_WORKERS)
+        workers = PARALLEL_MAX_WORKERS;
+
+    for (uint32_t i = 0; i < workers; i++)
+    {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, parallel_worker, NULL) != 0)
+            break;
+
+        pthread_detach(thread);
+        pool.workers++;
+    }
+}
+
+uint32_t parallel_threads()
+{
+    pthread_once(&pool_once, parallel_start_pool);
+
+    return pool.workers + 1;
+}
+
+void parallel_for(uint32_t count, parallel_body_t body, void *arg)
+{
+    if (count > 1 && !parallel_nested && parallel_threads() > 1 && pthread_mutex_trylock(&pool_submit) == 0)
+    {
+        parallel_job_t job = {body, arg, count, 0, 0, 0};
+
+        pthread_mutex_lock(&pool.lock);
+
+        pool.job = &job;
+        pool.generation++;
+
+        pthread_cond_broadcast(&pool.start);
+        pthread_mutex_unlock(&pool.lock);
+
+        parallel_nested = 1;
+        parallel_run(&job);
+        parallel_nested = 0;
+
+        pthread_mutex_lock(&pool.lock);
+
+        while (__atomic_load_n(&job.completed, __ATOMIC_ACQUIRE) < count || job.active > 0)
+            pthread_cond_wait(&pool.done, &pool.lock);
+
+        pool.job = NULL;
+
+        pthread_mutex_unlock(&pool.lock);
+        pthread_mutex_unlock(&pool_submit);
+
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        body(i, arg);
+    }
+}
@@ -25,7 +25,7 @@ void keygen(context_t *ctx, public_key_t *pk, player_t *players)
 
         for (uint32_t j = 0; j < ctx->n; j++)
         {
-            mpz_init_set(players[j].sk.S[i], shares[j].y);
+            mpz_set(players[j].sk.S[i], shares[j].y);
             mpz_clear_point(shares[j]);
         }
 
@@ -34,8 +34,112 @@ void keygen(context_t *ctx, public_key_t *pk, player_t *players)
     }
 }
 
+provision_t *keygen_seeded(context_t *ctx, public_key_t *pk, player_t *players)
+{
+    dealer_init_modulo(ctx, pk);
+
+    dealer_init_players(ctx, pk, players);
+
+    dealer_init_pk(ctx, pk);
+
+    uint32_t seeded = ctx->threshold < ctx->n ? ctx->threshold : ctx->n;
+
+    provision_t *provision = provision_new(ctx, seeded, pk->N);
+
+    // the dealer expands the same seeds: the t seeded shares of a component fix its polynomial
+    for (uint32_t j = 0; j < seeded; j++)
+    {
+        provision_expand(provision, j, players[j].sk.S, pk->N);
+    }
+
+    uint32_t explicit_players = ctx->n - seeded;
+
+    mpz_point_t *points = (mpz_point_t *)malloc(seeded * sizeof(mpz_point_t));
+    check_null_pointer(points);
+
+    mpz_point_t *shares = (mpz_point_t *)malloc(explicit_players * sizeof(mpz_point_t));
+    check_null_pointer(shares);
+
+    mpz_t *basis = (mpz_t *)malloc(seeded * seeded * sizeof(mpz_t));
+    check_null_pointer(basis);
+
+    mpz_t *polynomial = (mpz_t *)malloc(seeded * sizeof(mpz_t));
+    check_null_pointer(polynomial);
+
+    for (uint32_t j = 0; j < seeded; j++)
+    {
+        mpz_init_set_ui(points[j].x, j + 1);
+        mpz_inits(points[j].y, polynomial[j], NULL);
+    }
+
+    for (uint32_t q = 0; q < explicit_players; q++)
+    {
+        mpz_init_set_ui(shares[q].x, seeded + q + 1);
+        mpz_init(shares[q].y);
+    }
+
+    for (uint32_t j = 0; j < seeded * seeded; j++)
+    {
+        mpz_init(basis[j]);
+    }
+
+    lagrange_basis_coefficients(basis, points, seeded, pk->N);
+
+    // the polynomial through the seeded shares gives the secret, its constant term, and the
+    // explicit shares by Horner's method on small abscissas
+    for (uint32_t i = 0; i < ctx->l; i++)
+    {
+        for (uint32_t k = 0; k < seeded; k++)
+        {
+            mpz_set_ui(polynomial[k], 0);
+
+            for (uint32_t j = 0; j < seeded; j++)
+            {
+                mpz_addmul(polynomial[k], basis[j * seeded + k], players[j].sk.S[i]);
+            }
+
+            mpz_mod(polynomial[k], polynomial[k], pk->N);
+        }
+
+        dealer_polynomial_compute_public_key_i(pk, polynomial[0], i);
+
+        polynomial_eval_points(shares, explicit_players, polynomial, seeded, pk->N);
+
+        for (uint32_t q = 0; q < explicit_players; q++)
+        {
+            mpz_set(key_store_at(provision->corrections, q, ctx->l, i), shares[q].y);
+            mpz_set(players[seeded + q].sk.S[i], shares[q].y);
+        }
+    }
+
+    for (uint32_t j = 0; j < seeded; j++)
+    {
+        mpz_clear_point(points[j]);
+        mpz_clear(polynomial[j]);
+    }
+
+    for (uint32_t q = 0; q < explicit_players; q++)
+    {
+        mpz_clear_point(shares[q]);
+    }
+
+    for (uint32_t j = 0; j < seeded * seeded; j++)
+    {
+        mpz_clear(basis[j]);
+    }
+
+    free(points);
+    free(shares);
+    free(basis);
+    free(polynomial);
+
+    return provision;
+}
+
 signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j)
 {
+    arena_scope_begin();
+
     mpz_t y, z;
 
     mpz_point_t *r_shares = players_polynomial_compute_r_shares(ctx, pk);
@@ -46,7 +150,9 @@ signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const cha
 
     players_polynomial_compute_z(ctx, pk, players, &z, c, r_shares);
 
+    arena_scope_suspend();
     signature_t *signature = signature_malloc(y, z, j);
+    arena_scope_resume();
 
     mpz_clears(y, z, NULL);
 
@@ -58,32 +164,675 @@ signature_t *sign(context_t *ctx, public_key_t *pk, player_t *players, const cha
     free(r_shares);
     free(c);
 
+    arena_scope_end();
+
     return signature;
 }
 
-uint8_t update(context_t *ctx, public_key_t *pk, player_t *players, uint32_t j)
+signature_t *sign_beaver(context_t *ctx, public_key_t *pk, player_t *players, beaver_pool_t *pool, const char *m, uint32_t j)
 {
-    if (j >= ctx->T)
+    arena_scope_begin();
+
+    mpz_t y, z;
+    mpz_inits(y, z, NULL);
+
+    mpz_point_t *r_shares = players_polynomial_compute_r_shares(ctx, pk);
+
+    mpz_point_t *y_shares = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(y_shares);
+
+    mpz_point_t *key_shares = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(key_shares);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
     {
+        mpz_init_set(y_shares[i].x, r_shares[i].x);
+        mpz_init_set(y_shares[i].y, r_shares[i].y);
+        mpz_init_set_ui(key_shares[i].x, i + 1);
+        mpz_init(key_shares[i].y);
+    }
+
+    // r^(2^(T + 1 - j)), one square triple per squaring
+    for (uint32_t s = 0; s < ctx->T + 1 - j; s++)
+    {
+        beaver_mult(pool, y_shares, y_shares, y_shares);
+    }
+
+    beaver_open(pool, y, y_shares);
+
+    uint8_t *c = player_compute_c(ctx, y, j, m);
+
+    // z = r * prod(S_i^c_i), the r shares become the z shares
+    for (uint32_t i = 0; i < ctx->l; i++)
+    {
+        if (c[i] == 0)
+            continue;
+
+        for (uint32_t p = 0; p < ctx->n; p++)
+        {
+            mpz_set(key_shares[p].y, players[p].sk.S[i]);
+        }
+
+        beaver_mult(pool, r_shares, r_shares, key_shares);
+    }
+
+    beaver_open(pool, z, r_shares);
+
+    arena_scope_suspend();
+    signature_t *signature = signature_malloc(y, z, j);
+    arena_scope_resume();
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_clear_point(r_shares[i]);
+        mpz_clear_point(y_shares[i]);
+        mpz_clear_point(key_shares[i]);
+    }
+
+    free(r_shares);
+    free(y_shares);
+    free(key_shares);
+    free(c);
+
+    mpz_clears(y, z, NULL);
+
+    arena_scope_end();
+
+    return signature;
+}
+
+uint8_t keygen_packed(context_t *ctx, public_key_t *pk, player_t *players, uint32_t factor)
+{
+    if (!packed_fits(ctx->n, ctx->threshold, factor))
         return 0;
+
+    dealer_init_modulo(ctx, pk);
+
+    dealer_init_players_packed(ctx, pk, players, factor);
+
+    dealer_init_pk(ctx, pk);
+
+    packed_t *packing = packed_get(ctx->n, ctx->threshold, factor, pk->N);
+
+    mpz_t *secrets = (mpz_t *)malloc(factor * sizeof(mpz_t));
+    check_null_pointer(secrets);
+
+    mpz_t *shares = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(shares);
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        mpz_init(secrets[s]);
+    }
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_init(shares[i]);
+    }
+
+    for (uint32_t b = 0; b * factor < ctx->l; b++)
+    {
+        uint32_t count = ctx->l - b * factor < factor ? ctx->l - b * factor : factor;
+
+        for (uint32_t s = 0; s < count; s++)
+        {
+            mpz_set_random_n_coprime(secrets[s], pk->N, ctx->prng);
+
+            dealer_polynomial_compute_public_key_i(pk, secrets[s], b * factor + s);
+        }
+
+        packed_share(packing, shares, (const mpz_t *)secrets, count, ctx->prng);
+
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            mpz_set(players[i].sk.S[b], shares[i]);
+        }
+    }
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        mpz_clear(secrets[s]);
     }
 
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_clear(shares[i]);
+    }
+
+    free(secrets);
+    free(shares);
+
+    return 1;
+}
+
+signature_t *sign_packed(context_t *ctx, public_key_t *pk, player_t *players, const char *m, uint32_t j)
+{
+    uint32_t factor = players[0].sk.packing;
+
+    if (factor == 1)
+        return sign(ctx, pk, players, m, j);
+
+    arena_scope_begin();
+
+    packed_t *packing = packed_get(ctx->n, ctx->threshold, factor, pk->N);
+
+    mpz_t y, z;
+    mpz_init(z);
+
+    mpz_point_t *r_shares = players_polynomial_compute_r_shares(ctx, pk);
+
+    players_polynomial_compute_y(ctx, pk, &y, r_shares, j);
+
+    uint8_t *c = player_compute_c(ctx, y, j, m);
+
+    mpz_point_t *key_shares = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(key_shares);
+
+    mpz_t *lambda = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(lambda);
+
+    mpz_t *pack = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(pack);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_init_set_ui(key_shares[i].x, i + 1);
+        mpz_inits(key_shares[i].y, lambda[i], NULL);
+        mpz_init(pack[i]);
+    }
+
+    lagrange_coefficients_at_zero(lambda, r_shares, ctx->n, pk->N);
+
+    // z = r * prod(S_i^c_i), the r shares become the z shares
+    for (uint32_t b = 0; b * factor < ctx->l; b++)
+    {
+        uint32_t count = ctx->l - b * factor < factor ? ctx->l - b * factor : factor;
+        uint8_t selected = 0;
+
+        for (uint32_t s = 0; s < count; s++)
+        {
+            selected |= c[b * factor + s];
+        }
+
+        if (!selected)
+            continue;
+
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            mpz_set(pack[i], players[i].sk.S[b]);
+        }
+
+        // the players reshare their share of the pack towards a plain sharing of each selected slot
+        for (uint32_t s = 0; s < count; s++)
+        {
+            if (c[b * factor + s] == 0)
+                continue;
+
+            packed_unpack(packing, key_shares, (const mpz_t *)pack, s, ctx->prng);
+
+            mult_shamir_ss_batch_lambda(&r_shares, &r_shares, &key_shares, 1, ctx->n, ctx->threshold, (const mpz_t *)lambda, ctx->prng, pk->N);
+        }
+    }
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_addmul(z, lambda[i], r_shares[i].y);
+    }
+
+    mpz_mod(z, z, pk->N);
+
+    arena_scope_suspend();
+    signature_t *signature = signature_malloc(y, z, j);
+    arena_scope_resume();
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_clear_point(r_shares[i]);
+        mpz_clear_point(key_shares[i]);
+        mpz_clears(lambda[i], pack[i], NULL);
+    }
+
+    free(r_shares);
+    free(key_shares);
+    free(lambda);
+    free(pack);
+    free(c);
+
+    mpz_clears(y, z, NULL);
+
+    arena_scope_end();
+
+    return signature;
+}
+
+signature_t *sign_quorum(context_t *ctx, public_key_t *pk, player_t *players, const quorum_t *quorum, const char *m, uint32_t j)
+{
+    uint32_t size = quorum_size(quorum);
+
+    // the degree reduction of every multiplication needs 2t - 1 shares
+    if (size < 2 * ctx->threshold - 1 || size > ctx->n)
+        return NULL;
+
+    uint32_t *ids = (uint32_t *)malloc(size * sizeof(uint32_t));
+    check_null_pointer(ids);
+
+    quorum_ids(quorum, ids);
+
+    if (ids[size - 1] >= ctx->n)
+    {
+        free(ids);
+        return NULL;
+    }
+
+    arena_scope_begin();
+
+    const mpz_t *lambda = quorum_lagrange_at_zero(quorum, pk->N);
+
+    mpz_point_t *r_shares = (mpz_point_t *)malloc(size * sizeof(mpz_point_t));
+    check_null_pointer(r_shares);
+
+    mpz_point_t *y_shares = (mpz_point_t *)malloc(size * sizeof(mpz_point_t));
+    check_null_pointer(y_shares);
+
+    mpz_point_t *key_shares = (mpz_point_t *)malloc(size * sizeof(mpz_point_t));
+    check_null_pointer(key_shares);
+
+    mpz_t *secrets = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(secrets);
+
+    mpz_t y, z;
+    mpz_inits(y, z, NULL);
+
+    // only the players of the quorum take part, on their own abscissas
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_init_set_ui(r_shares[i].x, ids[i] + 1);
+        mpz_init_set_ui(y_shares[i].x, ids[i] + 1);
+        mpz_init_set_ui(key_shares[i].x, ids[i] + 1);
+        mpz_inits(r_shares[i].y, y_shares[i].y, key_shares[i].y, secrets[i], NULL);
+    }
+
+    // every player of the quorum shares a random value of its own, r is their sum
+    mpz_urandomm_array(secrets, size, ctx->prng, pk->N);
+
+    joint_shamir_ss_at(r_shares, secrets, ctx->threshold, size, ctx->prng, pk->N);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_set(y_shares[i].y, r_shares[i].y);
+    }
+
+    // r^(2^(T + 1 - j)) as a chain of squarings
+    for (uint32_t s = 0; s < ctx->T + 1 - j; s++)
+    {
+        mult_shamir_ss_batch_lambda(&y_shares, &y_shares, &y_shares, 1, size, ctx->threshold, lambda, ctx->prng, pk->N);
+    }
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_addmul(y, lambda[i], y_shares[i].y);
+    }
+
+    mpz_mod(y, y, pk->N);
+
+    uint8_t *c = player_compute_c(ctx, y, j, m);
+
+    // z = r * prod(S_i^c_i), the r shares become the z shares
     for (uint32_t i = 0; i < ctx->l; i++)
     {
+        if (c[i] == 0)
+            continue;
+
+        for (uint32_t p = 0; p < size; p++)
+        {
+            mpz_set(key_shares[p].y, players[ids[p]].sk.S[i]);
+        }
+
+        mult_shamir_ss_batch_lambda(&r_shares, &r_shares, &key_shares, 1, size, ctx->threshold, lambda, ctx->prng, pk->N);
+    }
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_addmul(z, lambda[i], r_shares[i].y);
+    }
+
+    mpz_mod(z, z, pk->N);
+
+    arena_scope_suspend();
+    signature_t *signature = signature_malloc(y, z, j);
+    arena_scope_resume();
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_clear_point(r_shares[i]);
+        mpz_clear_point(y_shares[i]);
+        mpz_clear_point(key_shares[i]);
+        mpz_clear(secrets[i]);
+    }
+
+    free(r_shares);
+    free(y_shares);
+    free(key_shares);
+    free(secrets);
+    free(ids);
+    free(c);
+
+    mpz_clears(y, z, NULL);
+
+    arena_scope_end();
+
+    return signature;
+}
+
+void sign_batch(context_t *ctx, public_key_t *pk, player_t *players, const char **msgs, uint32_t count, uint32_t j, signature_t *out)
+{
+    arena_scope_begin();
+
+    mpz_point_t **r_shares = (mpz_point_t **)malloc(count * sizeof(mpz_point_t *));
+    check_null_pointer(r_shares);
+
+    mpz_point_t **selected = (mpz_point_t **)malloc(count * sizeof(mpz_point_t *));
+    check_null_pointer(selected);
+
+    mpz_point_t **key = (mpz_point_t **)malloc(count * sizeof(mpz_point_t *));
+    check_null_pointer(key);
+
+    mpz_t *lambda = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(lambda);
+
+    mpz_t *Y = (mpz_t *)malloc(count * sizeof(mpz_t));
+    check_null_pointer(Y);
+
+    uint8_t *c = (uint8_t *)malloc(count * ctx->l * sizeof(uint8_t));
+    check_null_pointer(c);
+
+    mpz_t Z;
+    mpz_init(Z);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        r_shares[k] = players_polynomial_compute_r_shares(ctx, pk);
+        mpz_init(Y[k]);
+    }
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_init(lambda[i]);
+    }
+
+    lagrange_coefficients_at_zero(lambda, r_shares[0], ctx->n, pk->N);
+
+    // y_k = r_k^(2^(T + 1 - j)): every squaring is one resharing round for the whole batch
+    mpz_point_t **y_shares = (mpz_point_t **)malloc(count * sizeof(mpz_point_t *));
+    check_null_pointer(y_shares);
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        y_shares[k] = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+        check_null_pointer(y_shares[k]);
+
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            mpz_init_set(y_shares[k][i].x, r_shares[k][i].x);
+            mpz_init_set(y_shares[k][i].y, r_shares[k][i].y);
+        }
+    }
+
+    for (uint32_t s = 0; s < ctx->T + 1 - j; s++)
+    {
+        mult_shamir_ss_batch(y_shares, y_shares, y_shares, count, ctx->n, ctx->threshold, ctx->prng, pk->N);
+    }
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            mpz_addmul(Y[k], lambda[i], y_shares[k][i].y);
+            mpz_clear_point(y_shares[k][i]);
+        }
+
+        mpz_mod(Y[k], Y[k], pk->N);
+        free(y_shares[k]);
+    }
+
+    free(y_shares);
+
+    players_compute_c_batch(ctx, c, (const mpz_t *)Y, j, msgs, count);
+
+    // z_k = r_k * prod(S_i^c_k,i): the r shares become the z shares, key component i multiplies
+    // every message that has its bit set in a single batched round
+    for (uint32_t i = 0; i < ctx->l; i++)
+    {
+        uint32_t size = 0;
+
+        mpz_point_t *key_shares = player_polynomial_get_key_shares_i(ctx, players, i);
+
+        for (uint32_t k = 0; k < count; k++)
+        {
+            if (c[k * ctx->l + i])
+            {
+                selected[size] = r_shares[k];
+                key[size++] = key_shares;
+            }
+        }
+
+        if (size > 0)
+            mult_shamir_ss_batch(selected, selected, key, size, ctx->n, ctx->threshold, ctx->prng, pk->N);
+
+        for (uint32_t p = 0; p < ctx->n; p++)
+        {
+            mpz_clear_point(key_shares[p]);
+        }
+
+        free(key_shares);
+    }
+
+    for (uint32_t k = 0; k < count; k++)
+    {
+        mpz_set_ui(Z, 0);
+
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            mpz_addmul(Z, lambda[i], r_shares[k][i].y);
+            mpz_clear_point(r_shares[k][i]);
+        }
+
+        mpz_mod(Z, Z, pk->N);
+
+        arena_scope_suspend();
+        mpz_init_set(out[k].y, Y[k]);
+        mpz_init_set(out[k].z, Z);
+        out[k].j = j;
+        arena_scope_resume();
+
+        mpz_clear(Y[k]);
+        free(r_shares[k]);
+    }
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_clear(lambda[i]);
+    }
+
+    free(r_shares);
+    free(selected);
+    free(key);
+    free(lambda);
+    free(Y);
+    free(c);
+
+    mpz_clear(Z);
+
+    arena_scope_end();
+}
+
+/**
+ * @brief Squares `count` key components starting from `first` with `rounds` batched resharing rounds.
+ */
+static void update_key_components(context_t *ctx, public_key_t *pk, player_t *players, uint32_t first, uint32_t count, uint32_t rounds, gmp_randstate_t prng)
+{
+    mpz_point_t **keys = (mpz_point_t **)malloc(count * sizeof(mpz_point_t *));
+    check_null_pointer(keys);
 
-        mpz_point_t *tmp = player_polynomial_get_key_shares_i(ctx, players, i);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        keys[i] = player_polynomial_get_key_shares_i(ctx, players, first + i);
+    }
 
-        mult_shamir_ss(tmp, tmp, tmp, ctx->n, ctx->threshold, ctx->prng, pk->N);
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        mult_shamir_ss_batch(keys, keys, keys, count, ctx->n, ctx->threshold, prng, pk->N);
+    }
 
+    for (uint32_t i = 0; i < count; i++)
+    {
         for (uint32_t j = 0; j < ctx->n; j++)
         {
-            mpz_set(players[j].sk.S[i], tmp[j].y);
-            mpz_clear_point(tmp[j]);
+            arena_copy_out(players[j].sk.S[first + i], keys[i][j].y);
+            mpz_clear_point(keys[i][j]);
         }
 
-        free(tmp);
+        free(keys[i]);
     }
 
+    free(keys);
+}
+
+uint8_t update(context_t *ctx, public_key_t *pk, player_t *players, uint32_t j)
+{
+    if (j >= ctx->T)
+    {
+        return 0;
+    }
+
+    arena_scope_begin();
+
+    update_key_components(ctx, pk, players, 0, ctx->l, 1, ctx->prng);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        players[i].sk.j++;
+    }
+
+    arena_scope_end();
+
+    return 1;
+}
+
+uint8_t update_packed(context_t *ctx, public_key_t *pk, player_t *players, uint32_t j)
+{
+    uint32_t factor = players[0].sk.packing;
+
+    if (factor == 1)
+        return update(ctx, pk, players, j);
+
+    if (j >= ctx->T)
+    {
+        return 0;
+    }
+
+    arena_scope_begin();
+
+    packed_t *packing = packed_get(ctx->n, ctx->threshold, factor, pk->N);
+
+    mpz_t *pack = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(pack);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_init(pack[i]);
+    }
+
+    // one resharing round squares all the components of a pack
+    for (uint32_t b = 0; b * factor < ctx->l; b++)
+    {
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            mpz_set(pack[i], players[i].sk.S[b]);
+        }
+
+        packed_square(packing, pack, 1, ctx->prng);
+
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            arena_copy_out(players[i].sk.S[b], pack[i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_clear(pack[i]);
+        players[i].sk.j++;
+    }
+
+    free(pack);
+
+    arena_scope_end();
+
+    return 1;
+}
+
+typedef struct
+{
+    context_t *ctx;
+    public_key_t *pk;
+    player_t *players;
+    uint32_t rounds;
+    uint32_t chunks;
+    gmp_randstate_t *prngs;
+} update_to_job_t;
+
+static void update_to_chunk(uint32_t idx, void *arg)
+{
+    update_to_job_t *job = (update_to_job_t *)arg;
+
+    uint32_t first = idx * job->ctx->l / job->chunks;
+    uint32_t last = (idx + 1) * job->ctx->l / job->chunks;
+
+    arena_scope_begin();
+
+    update_key_components(job->ctx, job->pk, job->players, first, last - first, job->rounds, job->prngs[idx]);
+
+    arena_scope_end();
+}
+
+uint8_t update_to(context_t *ctx, public_key_t *pk, player_t *players, uint32_t target_period)
+{
+    if (target_period > ctx->T || target_period < players[0].sk.j)
+    {
+        return 0;
+    }
+
+    // one batched resharing per round for each thread, on its own slice of the key components
+    update_to_job_t job = {ctx, pk, players, target_period - players[0].sk.j, parallel_threads()};
+
+    if (job.chunks > ctx->l)
+    {
+        job.chunks = ctx->l;
+    }
+
+    job.prngs = (gmp_randstate_t *)malloc(job.chunks * sizeof(gmp_randstate_t));
+    check_null_pointer(job.prngs);
+
+    for (uint32_t i = 0; i < job.chunks; i++)
+    {
+        gmp_randinit_derived(job.prngs[i], ctx->prng);
+    }
+
+    parallel_for(job.chunks, update_to_chunk, &job);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        players[i].sk.j = target_period;
+    }
+
+    for (uint32_t i = 0; i < job.chunks; i++)
+    {
+        gmp_randclear(job.prngs[i]);
+    }
+
+    free(job.prngs);
+
     return 1;
 }
 
@@ -0,0 +1,75 @@
+#include "../include/provision.h"
+#include "../include/key-store.h"
+#include "../include/utils.h"
+
+provision_t *provision_new(context_t *ctx, uint32_t seeded, const mpz_t N)
+{
+    provision_t *provision = (provision_t *)malloc(sizeof(provision_t));
+    check_null_pointer(provision);
+
+    provision->n = ctx->n;
+    provision->l = ctx->l;
+    provision->seeded = seeded;
+
+    provision->seeds = (uint8_t *)malloc(seeded * PROVISION_SEED_BYTES);
+    check_null_pointer(provision->seeds);
+
+    mpz_t seed;
+    mpz_init(seed);
+
+    for (uint32_t i = 0; i < seeded; i++)
+    {
+        size_t len;
+
+        // the leading bytes dropped by the export stay zero
+        memset(provision->seeds + i * PROVISION_SEED_BYTES, 0, PROVISION_SEED_BYTES);
+
+        mpz_urandomb(seed, ctx->prng, PROVISION_SEED_BYTES * 8);
+        mpz_export(provision->seeds + i * PROVISION_SEED_BYTES, &len, -1, sizeof(uint8_t), 0, 0, seed);
+    }
+
+    mpz_clear(seed);
+
+    provision->corrections = seeded < ctx->n ? key_store_new((ctx->n - seeded) * ctx->l, N) : NULL;
+
+    return provision;
+}
+
+void provision_free(provision_t *provision)
+{
+    memset(provision->seeds, 0, provision->seeded * PROVISION_SEED_BYTES);
+    free(provision->seeds);
+
+    if (provision->corrections != NULL)
+        key_store_free(provision->corrections);
+
+    free(provision);
+}
+
+void provision_expand(const provision_t *provision, uint32_t id, mpz_t *dst, const mpz_t N)
+{
+    gmp_randstate_t state;
+    mpz_t seed;
+
+    // the seed keys a ChaCha stream of its own, whatever the backend of the dealer
+    random_init(state, RANDOM_BACKEND_CHACHA);
+
+    mpz_init(seed);
+    mpz_import(seed, PROVISION_SEED_BYTES, -1, sizeof(uint8_t), 0, 0, provision->seeds + id * PROVISION_SEED_BYTES);
+
+    gmp_randseed(state, seed);
+
+    mpz_urandomm_array(dst, provision->l, state, N);
+
+    mpz_set_ui(seed, 0);
+    mpz_clear(seed);
+
+    gmp_randclear(state);
+}
+
+size_t provision_size(const provision_t *provision, const mpz_t N)
+{
+    size_t explicit_shares = (size_t)(provision->n - provision->seeded) * provision->l;
+
+    return provision->seeded * PROVISION_SEED_BYTES + explicit_shares * mpz_size(N) * sizeof(mp_limb_t);
+}
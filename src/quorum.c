@@ -0,0 +1,122 @@
+#include "../include/quorum.h"
+#include "../include/utils.h"
+
+typedef struct
+{
+    quorum_t quorum;
+    mpz_t N;
+    mpz_t *lambda; // NULL for an empty entry
+    uint32_t size;
+    uint64_t used;
+} quorum_entry_t;
+
+static __thread quorum_entry_t quorum_cache[QUORUM_CACHE_SIZE];
+static __thread uint64_t quorum_clock;
+
+uint32_t quorum_ids(const quorum_t *q, uint32_t *ids)
+{
+    uint32_t size = 0;
+
+    for (uint32_t i = 0; i < QUORUM_WORDS; i++)
+    {
+        for (uint64_t word = q->bits[i]; word != 0; word &= word - 1)
+        {
+            ids[size++] = i * 64 + __builtin_ctzll(word);
+        }
+    }
+
+    return size;
+}
+
+static void quorum_entry_clear(quorum_entry_t *entry)
+{
+    for (uint32_t i = 0; i < entry->size; i++)
+    {
+        mpz_clear(entry->lambda[i]);
+    }
+
+    free(entry->lambda);
+    mpz_clear(entry->N);
+
+    entry->lambda = NULL;
+}
+
+const mpz_t *quorum_lagrange_at_zero(const quorum_t *q, const mpz_t N)
+{
+    quorum_entry_t *victim = &quorum_cache[0];
+
+    quorum_clock++;
+
+    for (uint32_t i = 0; i < QUORUM_CACHE_SIZE; i++)
+    {
+        quorum_entry_t *entry = &quorum_cache[i];
+
+        if (entry->lambda != NULL && memcmp(&entry->quorum, q, sizeof(quorum_t)) == 0 && mpz_cmp(entry->N, N) == 0)
+        {
+            entry->used = quorum_clock;
+            return (const mpz_t *)entry->lambda;
+        }
+
+        // an empty entry first, the least recently used one otherwise
+        if (victim->lambda != NULL && (entry->lambda == NULL || entry->used < victim->used))
+            victim = entry;
+    }
+
+    // the entries outlive any arena scope
+    arena_scope_suspend();
+
+    if (victim->lambda != NULL)
+        quorum_entry_clear(victim);
+
+    uint32_t size = quorum_size(q);
+
+    mpz_point_t *points = (mpz_point_t *)malloc(size * sizeof(mpz_point_t));
+    check_null_pointer(points);
+
+    uint32_t *ids = (uint32_t *)malloc(size * sizeof(uint32_t));
+    check_null_pointer(ids);
+
+    victim->lambda = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(victim->lambda);
+
+    quorum_ids(q, ids);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_init_set_ui(points[i].x, ids[i] + 1);
+        mpz_init(points[i].y);
+        mpz_init(victim->lambda[i]);
+    }
+
+    lagrange_coefficients_at_zero(victim->lambda, points, size, (mpz_ptr)N);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_clear_point(points[i]);
+    }
+
+    free(points);
+    free(ids);
+
+    mpz_init_set(victim->N, N);
+    victim->quorum = *q;
+    victim->size = size;
+    victim->used = quorum_clock;
+
+    arena_scope_resume();
+
+    return (const mpz_t *)victim->lambda;
+}
+
+void quorum_cache_clear()
+{
+    arena_scope_suspend();
+
+    for (uint32_t i = 0; i < QUORUM_CACHE_SIZE; i++)
+    {
+        if (quorum_cache[i].lambda != NULL)
+            quorum_entry_clear(&quorum_cache[i]);
+    }
+
+    arena_scope_resume();
+}
@@ -0,0 +1,214 @@
+#include "../include/random.h"
+#include "../include/utils.h"
+
+typedef __gmp_randstate_struct *random_state_ptr;
+typedef const __gmp_randstate_struct *random_state_srcptr;
+
+/**
+ * @brief Function table behind every `gmp_randstate_t`.
+ *
+ * Mirrors `gmp_randfnptr_t` of gmp-impl.h, which GMP reaches through `_mp_algdata._mp_lc` for
+ * every operation on a random state; the layout has not changed since GMP 4.
+ */
+typedef struct
+{
+    void (*randseed_fn)(gmp_randstate_t, mpz_srcptr);
+    void (*randget_fn)(gmp_randstate_t, mp_ptr, unsigned long int);
+    void (*randclear_fn)(gmp_randstate_t);
+    void (*randiset_fn)(random_state_ptr, random_state_srcptr);
+} random_functions_t;
+
+typedef struct
+{
+    struct chacha_ctx chacha;
+    uint8_t stream[RANDOM_CHACHA_BUFFER];
+    size_t offset;
+} random_chacha_t;
+
+static inline const random_functions_t *random_functions(random_state_srcptr state)
+{
+    return (const random_functions_t *)state->_mp_algdata._mp_lc;
+}
+
+// the ChaCha state lives where GMP keeps the limbs of the seed
+static inline random_chacha_t *random_chacha_state(random_state_srcptr state)
+{
+    return (random_chacha_t *)state->_mp_seed->_mp_d;
+}
+
+static void random_chacha_refill(random_chacha_t *r)
+{
+    memset(r->stream, 0, RANDOM_CHACHA_BUFFER);
+    chacha_crypt(&r->chacha, RANDOM_CHACHA_BUFFER, r->stream, r->stream);
+    r->offset = 0;
+}
+
+static void random_chacha_seed(gmp_randstate_t state, mpz_srcptr seed)
+{
+    random_chacha_t *r = random_chacha_state(state);
+    struct hash_context hash;
+    uint8_t key[hash_digest_len];
+    uint8_t nonce[CHACHA_NONCE_SIZE] = {0};
+    size_t len = (mpz_sizeinbase(seed, 2) + 7) / 8;
+
+    uint8_t *bytes = (uint8_t *)malloc(len);
+    check_null_pointer(bytes);
+
+    mpz_export(bytes, &len, -1, sizeof(uint8_t), 0, 0, seed);
+
+    hash_function_init(&hash);
+    hash_function_update(&hash, len, bytes);
+    hash_function_digest(&hash, hash_digest_len, key);
+
+    memset(bytes, 0, len);
+    free(bytes);
+
+    chacha_set_key(&r->chacha, key);
+    chacha_set_nonce(&r->chacha, nonce);
+
+    memset(key, 0, sizeof(key));
+
+    random_chacha_refill(r);
+}
+
+static void random_chacha_get(gmp_randstate_t state, mp_ptr dst, unsigned long int nbits)
+{
+    random_chacha_t *r = random_chacha_state(state);
+    size_t limbs = (nbits + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+    size_t len = limbs * sizeof(mp_limb_t);
+    uint8_t *out = (uint8_t *)dst;
+
+    if (limbs == 0)
+        return;
+
+    // what is left of the buffered keystream first
+    size_t take = RANDOM_CHACHA_BUFFER - r->offset;
+
+    if (take > len)
+        take = len;
+
+    memcpy(out, r->stream + r->offset, take);
+    r->offset += take;
+    out += take;
+    len -= take;
+
+    // bulk requests straight from the cipher, in whole blocks
+    size_t direct = len - len % CHACHA_BLOCK_SIZE;
+
+    if (direct > 0)
+    {
+        memset(out, 0, direct);
+        chacha_crypt(&r->chacha, direct, out, out);
+        out += direct;
+        len -= direct;
+    }
+
+    if (len > 0)
+    {
+        random_chacha_refill(r);
+        memcpy(out, r->stream, len);
+        r->offset = len;
+    }
+
+    if (nbits % GMP_NUMB_BITS != 0)
+        dst[limbs - 1] &= ((mp_limb_t)1 << (nbits % GMP_NUMB_BITS)) - 1;
+}
+
+static void random_chacha_clear(gmp_randstate_t state)
+{
+    random_chacha_t *r = random_chacha_state(state);
+
+    memset(r, 0, sizeof(random_chacha_t));
+    free(r);
+
+    state->_mp_seed->_mp_d = NULL;
+}
+
+static void random_chacha_iset(random_state_ptr dst, random_state_srcptr src);
+
+static const random_functions_t random_chacha_functions = {
+    random_chacha_seed,
+    random_chacha_get,
+    random_chacha_clear,
+    random_chacha_iset,
+};
+
+static void random_chacha_attach(random_state_ptr state, random_chacha_t *r)
+{
+    state->_mp_seed->_mp_d = (mp_limb_t *)r;
+    state->_mp_seed->_mp_alloc = sizeof(random_chacha_t) / sizeof(mp_limb_t);
+    state->_mp_seed->_mp_size = 0;
+
+    state->_mp_alg = GMP_RAND_ALG_DEFAULT;
+    state->_mp_algdata._mp_lc = (void *)&random_chacha_functions;
+}
+
+static void random_chacha_iset(random_state_ptr dst, random_state_srcptr src)
+{
+    random_chacha_t *r = (random_chacha_t *)malloc(sizeof(random_chacha_t));
+    check_null_pointer(r);
+
+    memcpy(r, random_chacha_state(src), sizeof(random_chacha_t));
+
+    random_chacha_attach(dst, r);
+}
+
+void random_init(gmp_randstate_t state, random_backend_t backend)
+{
+    if (backend == RANDOM_BACKEND_MT)
+    {
+        gmp_randinit_default(state);
+        return;
+    }
+
+    random_chacha_t *r = (random_chacha_t *)malloc(sizeof(random_chacha_t));
+    check_null_pointer(r);
+
+    random_chacha_attach(state, r);
+
+    // like the other GMP generators the state is usable before the first seeding
+    mpz_t seed;
+    mpz_init(seed);
+    random_chacha_seed(state, seed);
+    mpz_clear(seed);
+}
+
+random_backend_t random_backend(gmp_randstate_t state)
+{
+    return random_functions(state) == &random_chacha_functions ? RANDOM_BACKEND_CHACHA : RANDOM_BACKEND_MT;
+}
+
+const char *random_backend_name(random_backend_t backend)
+{
+    switch (backend)
+    {
+    case RANDOM_BACKEND_MT:
+        return "mt";
+    case RANDOM_BACKEND_CHACHA:
+        return "chacha";
+    }
+
+    return "unknown";
+}
+
+void mpz_urandomm_array(mpz_t *dst, uint32_t count, gmp_randstate_t state, const mpz_t N)
+{
+    size_t limbs = mpz_size(N) + (RANDOM_WIDE_BITS + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+    mpz_t wide;
+
+    if (count == 0)
+        return;
+
+    mp_limb_t *buffer = (mp_limb_t *)malloc(count * limbs * sizeof(mp_limb_t));
+    check_null_pointer(buffer);
+
+    random_functions(state)->randget_fn(state, buffer, count * limbs * GMP_NUMB_BITS);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        mpz_mod(dst[i], mpz_roinit_n(wide, buffer + i * limbs, limbs), N);
+    }
+
+    memset(buffer, 0, count * limbs * sizeof(mp_limb_t));
+    free(buffer);
+}
@@ -0,0 +1,636 @@
+#include "../include/runtime.h"
+
+#include <pthread.h>
+#include <string.h>
+
+/**
+ * @brief A serialized protocol message: a sequence of integers, each one as its limb count
+ * followed by the native limbs.
+ */
+typedef struct
+{
+    uint8_t *data;
+    size_t size;
+    size_t capacity;
+    size_t offset;
+} message_t;
+
+/**
+ * @brief What a player thread owns during a protocol step.
+ */
+typedef struct
+{
+    uint32_t id;
+    context_t ctx;
+    public_key_t *pk;
+    player_t *player;
+    transport_t *transport;
+    const mpz_t *lambda;
+
+    uint32_t rounds;
+    message_t *outgoing;
+    message_t *incoming;
+} node_t;
+
+typedef void (*node_body_t)(node_t *node, void *arg);
+
+typedef struct
+{
+    node_t *node;
+    node_body_t body;
+    void *arg;
+} node_thread_t;
+
+static void message_reset(message_t *msg)
+{
+    msg->size = 0;
+    msg->offset = 0;
+}
+
+static void message_put_mpz(message_t *msg, const mpz_t value)
+{
+    uint32_t header = mpz_size(value);
+    size_t bytes = header * sizeof(mp_limb_t);
+
+    if (msg->size + sizeof(header) + bytes > msg->capacity)
+    {
+        msg->capacity = 2 * (msg->size + sizeof(header) + bytes);
+        msg->data = (uint8_t *)realloc(msg->data, msg->capacity);
+        check_null_pointer(msg->data);
+    }
+
+    memcpy(msg->data + msg->size, &header, sizeof(header));
+    msg->size += sizeof(header);
+
+    // the players share the host: the limbs travel as they are, with no conversion
+    memcpy(msg->data + msg->size, mpz_limbs_read(value), bytes);
+    msg->size += bytes;
+}
+
+static void message_get_mpz(mpz_t value, message_t *msg)
+{
+    uint32_t header;
+
+    assert(msg->offset + sizeof(header) <= msg->size);
+
+    memcpy(&header, msg->data + msg->offset, sizeof(header));
+    msg->offset += sizeof(header);
+
+    size_t bytes = header * sizeof(mp_limb_t);
+
+    assert(msg->offset + bytes <= msg->size);
+
+    if (header == 0)
+    {
+        mpz_set_ui(value, 0);
+        return;
+    }
+
+    memcpy(mpz_limbs_write(value, header), msg->data + msg->offset, bytes);
+    mpz_limbs_finish(value, header);
+    msg->offset += bytes;
+}
+
+/**
+ * @brief One communication round: sends `outgoing[k]` to every player k and fills `incoming[k]`.
+ *
+ * The message to itself is not sent but moved to `incoming[id]`.
+ */
+static void node_exchange(node_t *node)
+{
+    uint32_t n = node->ctx.n;
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        if (k != node->id)
+            transport_send(node->transport, node->id, k, node->outgoing[k].data, node->outgoing[k].size);
+    }
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        message_t *in = &node->incoming[k];
+
+        free(in->data);
+
+        if (k == node->id)
+        {
+            *in = node->outgoing[k];
+            node->outgoing[k].data = NULL;
+            node->outgoing[k].capacity = 0;
+        }
+        else
+        {
+            in->data = transport_recv(node->transport, node->id, k, &in->size);
+            in->capacity = in->size;
+        }
+
+        in->offset = 0;
+        message_reset(&node->outgoing[k]);
+    }
+
+    node->rounds++;
+}
+
+static void *node_thread(void *arg)
+{
+    node_thread_t *thread = (node_thread_t *)arg;
+
+    thread->body(thread->node, thread->arg);
+
+    return NULL;
+}
+
+/**
+ * @brief Runs `body` on every player, each in its own thread, and collects the step cost.
+ */
+static void runtime_run(runtime_t *rt, node_body_t body, void *arg)
+{
+    uint32_t n = rt->ctx->n;
+
+    node_t *nodes = (node_t *)calloc(n, sizeof(node_t));
+    check_null_pointer(nodes);
+
+    node_thread_t *threads = (node_thread_t *)malloc(n * sizeof(node_thread_t));
+    check_null_pointer(threads);
+
+    pthread_t *handles = (pthread_t *)malloc(n * sizeof(pthread_t));
+    check_null_pointer(handles);
+
+    transport_reset_counters(rt->transport);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        nodes[i].id = i;
+        nodes[i].ctx = *rt->ctx;
+        nodes[i].pk = rt->pk;
+        nodes[i].player = &rt->players[i];
+        nodes[i].transport = rt->transport;
+        nodes[i].lambda = (const mpz_t *)rt->lambda;
+
+        gmp_randinit_derived(nodes[i].ctx.prng, rt->ctx->prng);
+
+        nodes[i].outgoing = (message_t *)calloc(n, sizeof(message_t));
+        check_null_pointer(nodes[i].outgoing);
+
+        nodes[i].incoming = (message_t *)calloc(n, sizeof(message_t));
+        check_null_pointer(nodes[i].incoming);
+
+        threads[i] = (node_thread_t){&nodes[i], body, arg};
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        if (pthread_create(&handles[i], NULL, node_thread, &threads[i]) != 0)
+        {
+            fputs("Error while starting a player thread.", stderr);
+            exit(-1);
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        pthread_join(handles[i], NULL);
+    }
+
+    rt->stats.bytes = atomic_load(&rt->transport->bytes);
+    rt->stats.messages = atomic_load(&rt->transport->messages);
+    rt->stats.rounds = nodes[0].rounds;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        for (uint32_t k = 0; k < n; k++)
+        {
+            free(nodes[i].outgoing[k].data);
+            free(nodes[i].incoming[k].data);
+        }
+
+        free(nodes[i].outgoing);
+        free(nodes[i].incoming);
+
+        gmp_randclear(nodes[i].ctx.prng);
+    }
+
+    free(handles);
+    free(threads);
+    free(nodes);
+}
+
+runtime_t *runtime_new(context_t *ctx, public_key_t *pk, player_t *players, transport_kind_t kind)
+{
+    runtime_t *rt = (runtime_t *)calloc(1, sizeof(runtime_t));
+    check_null_pointer(rt);
+
+    rt->ctx = ctx;
+    rt->pk = pk;
+    rt->players = players;
+    rt->transport = transport_new(kind, ctx->n);
+
+    rt->lambda = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(rt->lambda);
+
+    mpz_point_t *points = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(points);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_init(rt->lambda[i]);
+        mpz_init_set_ui(points[i].x, i + 1);
+        mpz_init(points[i].y);
+    }
+
+    lagrange_coefficients_at_zero(rt->lambda, points, ctx->n, pk->N);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        mpz_clear_point(points[i]);
+    }
+
+    free(points);
+
+    return rt;
+}
+
+void runtime_free(runtime_t *rt)
+{
+    for (uint32_t i = 0; i < rt->ctx->n; i++)
+    {
+        mpz_clear(rt->lambda[i]);
+    }
+
+    free(rt->lambda);
+
+    transport_free(rt->transport);
+
+    free(rt);
+}
+
+void printf_runtime_stats(const char *name, const runtime_t *rt)
+{
+    printf("%s: bytes=%lu, messages=%lu, rounds=%u\n", name, rt->stats.bytes, rt->stats.messages, rt->stats.rounds);
+}
+
+typedef struct
+{
+    const char *m;
+    uint32_t j;
+    signature_t *signature;
+} runtime_sign_t;
+
+#ifdef USE_POLYNOMIAL
+
+/**
+ * @brief Joint random sharing: every player shares a random value and keeps the sum of its shares.
+ */
+static void node_polynomial_random(node_t *node, mpz_t dst)
+{
+    context_t *ctx = &node->ctx;
+
+    mpz_t secret, share;
+    mpz_inits(secret, share, NULL);
+
+    mpz_point_t *shares = (mpz_point_t *)malloc(ctx->n * sizeof(mpz_point_t));
+    check_null_pointer(shares);
+
+    mpz_urandomm(secret, ctx->prng, node->pk->N);
+
+    shamir_ss(shares, ctx->n, secret, ctx->threshold, ctx->prng, node->pk->N);
+
+    for (uint32_t k = 0; k < ctx->n; k++)
+    {
+        message_put_mpz(&node->outgoing[k], shares[k].y);
+        mpz_clear_point(shares[k]);
+    }
+
+    node_exchange(node);
+
+    mpz_set_ui(dst, 0);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        message_get_mpz(share, &node->incoming[i]);
+        mpz_add(dst, dst, share);
+    }
+
+    mpz_mod(dst, dst, node->pk->N);
+
+    free(shares);
+    mpz_clears(secret, share, NULL);
+}
+
+/**
+ * @brief Multiplies `count` pairs of shares with one degree reduction round.
+ *
+ * Every player reshares its local products and interpolates at zero the shares it receives.
+ * `dst` may alias `a` or `b`.
+ */
+static void node_polynomial_mult(node_t *node, mpz_t *dst, mpz_t *a, mpz_t *b, uint32_t count)
+{
+    context_t *ctx = &node->ctx;
+    mpz_ptr N = node->pk->N;
+
+    mpz_t *polynomial = (mpz_t *)malloc(ctx->threshold * sizeof(mpz_t));
+    check_null_pointer(polynomial);
+
+    mpz_t evaluation, share;
+    mpz_inits(evaluation, share, NULL);
+
+    for (uint32_t i = 0; i < ctx->threshold; i++)
+    {
+        mpz_init(polynomial[i]);
+    }
+
+    for (uint32_t c = 0; c < count; c++)
+    {
+        mpz_mul(polynomial[0], a[c], b[c]);
+        mpz_mod(polynomial[0], polynomial[0], N);
+
+        for (uint32_t j = 1; j < ctx->threshold; j++)
+        {
+            do
+                mpz_urandomm(polynomial[j], ctx->prng, N);
+            while (mpz_cmp_ui(polynomial[j], 0) == 0);
+        }
+
+        for (uint32_t k = 0; k < ctx->n; k++)
+        {
+            // Horner's method
+            mpz_set(evaluation, polynomial[ctx->threshold - 1]);
+
+            for (int32_t j = ctx->threshold - 2; j >= 0; j--)
+            {
+                mpz_mul_ui(evaluation, evaluation, k + 1);
+                mpz_add(evaluation, evaluation, polynomial[j]);
+                mpz_mod(evaluation, evaluation, N);
+            }
+
+            message_put_mpz(&node->outgoing[k], evaluation);
+        }
+    }
+
+    node_exchange(node);
+
+    for (uint32_t c = 0; c < count; c++)
+    {
+        // dst may be a key store slot, the sum is only reduced at the end
+        mpz_set_ui(evaluation, 0);
+
+        for (uint32_t i = 0; i < ctx->n; i++)
+        {
+            message_get_mpz(share, &node->incoming[i]);
+            mpz_addmul(evaluation, node->lambda[i], share);
+        }
+
+        mpz_mod(dst[c], evaluation, N);
+    }
+
+    for (uint32_t i = 0; i < ctx->threshold; i++)
+    {
+        mpz_clear(polynomial[i]);
+    }
+
+    free(polynomial);
+    mpz_clears(evaluation, share, NULL);
+}
+
+/**
+ * @brief Reveals a shared value to every player.
+ */
+static void node_polynomial_open(node_t *node, mpz_t dst, mpz_t share)
+{
+    mpz_t received;
+    mpz_init(received);
+
+    for (uint32_t k = 0; k < node->ctx.n; k++)
+    {
+        message_put_mpz(&node->outgoing[k], share);
+    }
+
+    node_exchange(node);
+
+    mpz_set_ui(dst, 0);
+
+    for (uint32_t i = 0; i < node->ctx.n; i++)
+    {
+        message_get_mpz(received, &node->incoming[i]);
+        mpz_addmul(dst, node->lambda[i], received);
+    }
+
+    mpz_mod(dst, dst, node->pk->N);
+
+    mpz_clear(received);
+}
+
+static void node_sign(node_t *node, void *arg)
+{
+    runtime_sign_t *step = (runtime_sign_t *)arg;
+    context_t *ctx = &node->ctx;
+
+    mpz_t r, y, Y, Z;
+    mpz_inits(r, y, Y, Z, NULL);
+
+    node_polynomial_random(node, r);
+
+    // y = r^(2^(T + 1 - j)), one squaring per round
+    mpz_set(y, r);
+
+    for (uint32_t i = 0; i < ctx->T + 1 - step->j; i++)
+    {
+        node_polynomial_mult(node, &y, &y, &y, 1);
+    }
+
+    node_polynomial_open(node, Y, y);
+
+    uint8_t *c = player_compute_c(ctx, Y, step->j, step->m);
+
+    // z = r * prod(S_i^c_i): the factors are multiplied pairwise, one round per level of the tree
+    mpz_t *factors = (mpz_t *)malloc((ctx->l + 1) * sizeof(mpz_t));
+    check_null_pointer(factors);
+
+    uint32_t w = 0;
+
+    mpz_init_set(factors[w++], r);
+
+    for (uint32_t i = 0; i < ctx->l; i++)
+    {
+        if (c[i])
+            mpz_init_set(factors[w++], node->player->sk.S[i]);
+    }
+
+    uint32_t allocated = w;
+
+    while (w > 1)
+    {
+        uint32_t half = w / 2;
+
+        node_polynomial_mult(node, factors, factors, factors + half, half);
+
+        if (w % 2)
+            mpz_swap(factors[half], factors[w - 1]);
+
+        w = half + w % 2;
+    }
+
+    node_polynomial_open(node, Z, factors[0]);
+
+    if (node->id == 0)
+        step->signature = signature_malloc(Y, Z, step->j);
+
+    for (uint32_t i = 0; i < allocated; i++)
+    {
+        mpz_clear(factors[i]);
+    }
+
+    free(factors);
+    free(c);
+
+    mpz_clears(r, y, Y, Z, NULL);
+}
+
+static void node_update(node_t *node, void *arg)
+{
+    // the l components are squared in a single degree reduction round
+    node_polynomial_mult(node, node->player->sk.S, node->player->sk.S, node->player->sk.S, node->ctx.l);
+
+    node->player->sk.j++;
+}
+
+#else
+
+/**
+ * @brief Sends the same value to every player and multiplies the received ones.
+ */
+static void node_multiplicative_broadcast_product(node_t *node, mpz_t dst, mpz_t value)
+{
+    mpz_t received;
+    mpz_init(received);
+
+    for (uint32_t k = 0; k < node->ctx.n; k++)
+    {
+        message_put_mpz(&node->outgoing[k], value);
+    }
+
+    node_exchange(node);
+
+    mpz_set_ui(dst, 1);
+
+    for (uint32_t i = 0; i < node->ctx.n; i++)
+    {
+        message_get_mpz(received, &node->incoming[i]);
+        mpz_mul(dst, dst, received);
+        mpz_mod(dst, dst, node->pk->N);
+    }
+
+    mpz_clear(received);
+}
+
+static void node_sign(node_t *node, void *arg)
+{
+    runtime_sign_t *step = (runtime_sign_t *)arg;
+
+    mpz_t r, y, z, Y, Z;
+    mpz_inits(Y, Z, NULL);
+
+    player_multiplicative_compute_r(&node->ctx, node->pk, &r);
+    player_multiplicative_compute_y(&node->ctx, node->pk, &y, r, step->j);
+
+    node_multiplicative_broadcast_product(node, Y, y);
+
+    uint8_t *c = player_compute_c(&node->ctx, Y, step->j, step->m);
+
+    player_multiplicative_compute_z(&node->ctx, node->pk, &z, r, node->player->sk.S, c);
+
+    node_multiplicative_broadcast_product(node, Z, z);
+
+    if (node->id == 0)
+        step->signature = signature_malloc(Y, Z, step->j);
+
+    free(c);
+
+    mpz_clears(r, y, z, Y, Z, NULL);
+}
+
+static void node_update(node_t *node, void *arg)
+{
+    for (uint32_t i = 0; i < node->ctx.l; i++)
+    {
+        mpz_powm_ui(node->player->sk.S[i], node->player->sk.S[i], 2, node->pk->N);
+    }
+
+    node->player->sk.j++;
+}
+
+static void node_refresh(node_t *node, void *arg)
+{
+    context_t *ctx = &node->ctx;
+
+    mpz_t value, product, factor;
+    mpz_inits(value, product, factor, NULL);
+
+    mpz_t *values = (mpz_t *)malloc(ctx->n * sizeof(mpz_t));
+    check_null_pointer(values);
+
+    for (uint32_t k = 0; k < ctx->n; k++)
+    {
+        mpz_init(values[k]);
+    }
+
+    // n - 1 random values to the first players, the inverse of their product to the last one;
+    // nothing is sent yet, so values sharing a factor with N are simply drawn again
+    do
+    {
+        mpz_urandomm_array(values, ctx->n - 1, ctx->prng, node->pk->N);
+        mpz_mmul_array(product, values, ctx->n - 1, node->pk->N);
+    } while (mpz_invert(values[ctx->n - 1], product, node->pk->N) == 0);
+
+    for (uint32_t k = 0; k < ctx->n; k++)
+    {
+        message_put_mpz(&node->outgoing[k], values[k]);
+        mpz_clear(values[k]);
+    }
+
+    free(values);
+
+    node_exchange(node);
+
+    mpz_set_ui(factor, 1);
+
+    for (uint32_t i = 0; i < ctx->n; i++)
+    {
+        message_get_mpz(value, &node->incoming[i]);
+        mpz_mul(factor, factor, value);
+        mpz_mod(factor, factor, node->pk->N);
+    }
+
+    player_multiplicative_compute_new_secret_share(ctx, node->pk, node->player, factor);
+    player_multiplicative_compute_new_verification_keys(ctx, node->pk, node->player, factor);
+
+    mpz_clears(value, product, factor, NULL);
+}
+
+void runtime_refresh(runtime_t *rt)
+{
+    runtime_run(rt, node_refresh, NULL);
+}
+
+#endif
+
+signature_t *runtime_sign(runtime_t *rt, const char *m, uint32_t j)
+{
+    runtime_sign_t step = {m, j, NULL};
+
+    runtime_run(rt, node_sign, &step);
+
+    return step.signature;
+}
+
+uint8_t runtime_update(runtime_t *rt, uint32_t j)
+{
+    if (j >= rt->ctx->T)
+    {
+        return 0;
+    }
+
+    runtime_run(rt, node_update, NULL);
+
+    return 1;
+}
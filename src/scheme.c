@@ -4,23 +4,17 @@ void cleanup(context_t *ctx, public_key_t *pk, player_t *players)
 {
     mpz_clear(pk->N);
 
-    for (uint32_t i = 0; i < ctx->l; i++)
-    {
-        mpz_clear(pk->U[i]);
-    }
+    key_store_free(pk->store);
+
+    if (pk->verification != NULL)
+        key_store_free(pk->verification);
 
-    free(pk->U);
+    // the shares of every player are in the store of the first one
+    key_store_free(players[0].sk.store);
 
     for (uint32_t i = 0; i < ctx->n; i++)
     {
         mpz_clear(players[i].sk.N);
-
-        for (uint32_t j = 0; j < ctx->l; j++)
-        {
-            mpz_clear(players[i].sk.S[j]);
-        }
-
-        free(players[i].sk.S);
     }
 
     free(players);
@@ -56,4 +50,83 @@ uint8_t verify(context_t *ctx, public_key_t *pk, const char *m, const signature_
     mpz_clear(tmp);
 
     return res;
-}
\ No newline at end of file
+}
+typedef struct
+{
+    context_t *ctx;
+    public_key_t *pk;
+    const signature_t *s;
+    const uint8_t *c;
+    uint32_t parts;
+
+    // parts[0] is z^(2^(T + 1 - j)), the others the slices of the subset product
+    mpz_t *results;
+} verify_job_t;
+
+static void verify_part(uint32_t idx, void *arg)
+{
+    verify_job_t *job = (verify_job_t *)arg;
+
+    if (idx == 0)
+    {
+        mpz_set(job->results[0], job->s->z);
+        mpz_double_pow(job->results[0], job->pk->T, job->s->j, job->pk->N);
+        return;
+    }
+
+    uint32_t slices = job->parts - 1;
+    uint32_t first = (uint32_t)((uint64_t)job->ctx->l * (idx - 1) / slices);
+    uint32_t last = (uint32_t)((uint64_t)job->ctx->l * idx / slices);
+
+    mpz_t one;
+    mpz_init_set_ui(one, 1);
+
+    // the first slice starts from y, the others from 1
+    mpz_mmul_pow_array(job->results[idx], idx == 1 ? job->s->y : one, job->c + first, job->pk->U + first,
+                       last - first, job->pk->N);
+
+    mpz_clear(one);
+}
+
+uint8_t verify_parallel(context_t *ctx, public_key_t *pk, const char *m, const signature_t *s)
+{
+    if (mpz_divisible_p(s->y, pk->N) != 0)
+        return 0;
+
+    uint8_t *c = player_compute_c(ctx, s->y, s->j, m);
+
+    uint32_t parts = 2;
+
+    if (ctx->l >= VERIFY_PARALLEL_SPLIT_MIN_L && parallel_threads() > 2)
+        parts = parallel_threads();
+
+    mpz_t *results = (mpz_t *)malloc(parts * sizeof(mpz_t));
+    check_null_pointer(results);
+
+    for (uint32_t i = 0; i < parts; i++)
+    {
+        mpz_init(results[i]);
+    }
+
+    verify_job_t job = {ctx, pk, s, c, parts, results};
+
+    parallel_for(parts, verify_part, &job);
+
+    for (uint32_t i = 2; i < parts; i++)
+    {
+        mpz_mul(results[1], results[1], results[i]);
+        mpz_mod(results[1], results[1], pk->N);
+    }
+
+    uint8_t res = mpz_congruent_p(results[0], results[1], pk->N) != 0;
+
+    for (uint32_t i = 0; i < parts; i++)
+    {
+        mpz_clear(results[i]);
+    }
+
+    free(results);
+    free(c);
+
+    return res;
+}
@@ -0,0 +1,42 @@
+#include "../include/session.h"
+
+session_t *session_new(const context_t *ctx, public_key_t *pk, player_t *players)
+{
+    session_t *session = (session_t *)malloc(sizeof(session_t));
+    check_null_pointer(session);
+
+    session->ctx.l = ctx->l;
+    session->ctx.n = ctx->n;
+    session->ctx.k = ctx->k;
+    session->ctx.T = ctx->T;
+    session->ctx.threshold = ctx->threshold;
+
+    session->pk = pk;
+    session->players = players;
+
+    random_init(session->ctx.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(session->ctx.prng, 128);
+
+    return session;
+}
+
+void session_free(session_t *session)
+{
+    gmp_randclear(session->ctx.prng);
+    free(session);
+}
+
+signature_t *session_sign(session_t *session, const char *m, uint32_t j)
+{
+    return sign(&session->ctx, session->pk, session->players, m, j);
+}
+
+void session_sign_batch(session_t *session, const char **msgs, uint32_t count, uint32_t j, signature_t *out)
+{
+    sign_batch(&session->ctx, session->pk, session->players, msgs, count, j, out);
+}
+
+uint8_t session_verify(session_t *session, const char *m, const signature_t *s)
+{
+    return verify(&session->ctx, session->pk, m, s);
+}
@@ -19,3 +19,9 @@ void signature_free(signature_t *s)
     mpz_clear(s->z);
     free(s);
 }
+
+void signature_clear(signature_t *s)
+{
+    mpz_clear(s->y);
+    mpz_clear(s->z);
+}
@@ -0,0 +1,452 @@
+#include "../include/simd-mont.h"
+#include "../include/utils.h"
+
+#include <immintrin.h>
+#include <cpuid.h>
+
+/**
+ * @brief Montgomery parameters of a modulus, with every constant already spread over the lanes.
+ *
+ * Lane `k` of digit `i` of a value is at `[i * lanes + k]`, so digit `i` of all the lanes is one
+ * vector load.
+ */
+typedef struct
+{
+    simd_mont_isa_t isa;
+    uint32_t lanes;
+    uint32_t bits; // digit size
+    uint32_t digits;
+    uint64_t mask;
+    uint64_t ninv; // -1/N mod 2^bits
+
+    uint32_t size; // limbs of N
+    mp_limb_t key[SIMD_MONT_MAX_BITS / GMP_NUMB_BITS];
+
+    uint64_t N[SIMD_MONT_MAX_DIGITS * SIMD_MONT_MAX_LANES] __attribute__((aligned(64)));
+    uint64_t R2[SIMD_MONT_MAX_DIGITS * SIMD_MONT_MAX_LANES] __attribute__((aligned(64)));
+    uint64_t one[SIMD_MONT_MAX_DIGITS * SIMD_MONT_MAX_LANES] __attribute__((aligned(64)));
+    uint64_t x[SIMD_MONT_MAX_DIGITS * SIMD_MONT_MAX_LANES] __attribute__((aligned(64)));
+} simd_mont_t;
+
+static simd_mont_isa_t simd_mont_selected;
+static pthread_once_t simd_mont_once = PTHREAD_ONCE_INIT;
+
+static __thread simd_mont_t simd_mont_cache;
+
+static uint8_t simd_mont_has_adx()
+{
+    uint32_t eax, ebx, ecx, edx;
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+    return (ebx >> 19) & 1;
+}
+
+simd_mont_isa_t simd_mont_best_isa()
+{
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma"))
+        return SIMD_MONT_AVX512_IFMA;
+
+    // with ADX GMP's 64 bit mulx chains are faster than four lanes of 26 bit digits
+    if (__builtin_cpu_supports("avx2") && !simd_mont_has_adx())
+        return SIMD_MONT_AVX2;
+
+    return SIMD_MONT_NONE;
+}
+
+static void simd_mont_detect()
+{
+    simd_mont_selected = simd_mont_best_isa();
+}
+
+simd_mont_isa_t simd_mont_isa()
+{
+    pthread_once(&simd_mont_once, simd_mont_detect);
+
+    return simd_mont_selected;
+}
+
+simd_mont_isa_t simd_mont_set_isa(simd_mont_isa_t isa)
+{
+    pthread_once(&simd_mont_once, simd_mont_detect);
+
+    __builtin_cpu_init();
+
+    if (isa == SIMD_MONT_AVX512_IFMA && !(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma")))
+        isa = SIMD_MONT_NONE;
+
+    if (isa == SIMD_MONT_AVX2 && !__builtin_cpu_supports("avx2"))
+        isa = SIMD_MONT_NONE;
+
+    simd_mont_selected = isa;
+
+    return isa;
+}
+
+uint32_t simd_mont_lanes(simd_mont_isa_t isa)
+{
+    switch (isa)
+    {
+    case SIMD_MONT_AVX512_IFMA:
+        return 8;
+    case SIMD_MONT_AVX2:
+        return 4;
+    default:
+        return 1;
+    }
+}
+
+const char *simd_mont_isa_name(simd_mont_isa_t isa)
+{
+    switch (isa)
+    {
+    case SIMD_MONT_AVX512_IFMA:
+        return "avx512ifma";
+    case SIMD_MONT_AVX2:
+        return "avx2";
+    case SIMD_MONT_NONE:
+        return "none";
+    }
+
+    return "unknown";
+}
+
+/**
+ * @brief out = a * b / R mod N on 8 lanes of radix 2^52 digits.
+ *
+ * IFMA splits each product into its low and high 52 bits; they are accumulated unreduced in
+ * separate columns (`lo` and `hi`, the high half of column k belonging to column k + 1) so that
+ * the multiply-adds of a row do not depend on each other. A column collects at most 4 * digits
+ * halves of 52 bits, below 2^61 for 80 digits. Row i folds the finished high column i - 1 into
+ * column i, clears its low digit with q * N and pushes the rest into column i + 1.
+ */
+__attribute__((target("avx512f,avx512ifma"))) static void simd_mont_mul_ifma(const simd_mont_t *m, uint64_t *out, const uint64_t *a, const uint64_t *b)
+{
+    const uint32_t n = m->digits;
+    __m512i lo[2 * SIMD_MONT_MAX_DIGITS + 1], hi[2 * SIMD_MONT_MAX_DIGITS + 1];
+
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i mask = _mm512_set1_epi64(m->mask);
+    const __m512i ninv = _mm512_set1_epi64(m->ninv);
+    const __m512i a0 = _mm512_load_si512((const void *)a);
+
+    for (uint32_t i = 0; i <= 2 * n; i++)
+    {
+        lo[i] = zero;
+        hi[i] = zero;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const __m512i bi = _mm512_load_si512((const void *)(b + i * 8));
+
+        if (i > 0)
+            lo[i] = _mm512_add_epi64(lo[i], hi[i - 1]);
+
+        const __m512i q = _mm512_madd52lo_epu64(zero, _mm512_madd52lo_epu64(lo[i], a0, bi), ninv);
+
+        for (uint32_t j = 0; j < n; j++)
+        {
+            const __m512i aj = _mm512_load_si512((const void *)(a + j * 8));
+            const __m512i nj = _mm512_load_si512((const void *)(m->N + j * 8));
+
+            lo[i + j] = _mm512_madd52lo_epu64(_mm512_madd52lo_epu64(lo[i + j], aj, bi), nj, q);
+            hi[i + j] = _mm512_madd52hi_epu64(_mm512_madd52hi_epu64(hi[i + j], aj, bi), nj, q);
+        }
+
+        // the low digit of column i is now zero
+        lo[i + 1] = _mm512_add_epi64(lo[i + 1], _mm512_srli_epi64(lo[i], 52));
+    }
+
+    __m512i carry = zero;
+
+    for (uint32_t i = n; i < 2 * n; i++)
+    {
+        __m512i column = _mm512_add_epi64(_mm512_add_epi64(lo[i], hi[i - 1]), carry);
+
+        carry = _mm512_srli_epi64(column, 52);
+        _mm512_store_si512((void *)(out + (i - n) * 8), _mm512_and_si512(column, mask));
+    }
+}
+
+/**
+ * @brief out = a * b / R mod N on 4 lanes of radix 2^26 digits.
+ *
+ * `vpmuludq` gives the whole 52 bit product of two digits, added to a single column: column i
+ * collects at most 2 * digits products, below 2^61 for 158 digits.
+ */
+__attribute__((target("avx2"))) static void simd_mont_mul_avx2(const simd_mont_t *m, uint64_t *out, const uint64_t *a, const uint64_t *b)
+{
+    const uint32_t n = m->digits;
+    __m256i acc[2 * SIMD_MONT_MAX_DIGITS + 1];
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mask = _mm256_set1_epi64x(m->mask);
+    const __m256i ninv = _mm256_set1_epi64x(m->ninv);
+    const __m256i a0 = _mm256_load_si256((const __m256i *)a);
+
+    for (uint32_t i = 0; i <= 2 * n; i++)
+    {
+        acc[i] = zero;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const __m256i bi = _mm256_load_si256((const __m256i *)(b + i * 4));
+        const __m256i t = _mm256_add_epi64(acc[i], _mm256_mul_epu32(a0, bi));
+        const __m256i q = _mm256_and_si256(_mm256_mul_epu32(_mm256_and_si256(t, mask), ninv), mask);
+
+        for (uint32_t j = 0; j < n; j++)
+        {
+            const __m256i aj = _mm256_load_si256((const __m256i *)(a + j * 4));
+            const __m256i nj = _mm256_load_si256((const __m256i *)(m->N + j * 4));
+
+            acc[i + j] = _mm256_add_epi64(acc[i + j], _mm256_add_epi64(_mm256_mul_epu32(aj, bi), _mm256_mul_epu32(nj, q)));
+        }
+
+        acc[i + 1] = _mm256_add_epi64(acc[i + 1], _mm256_srli_epi64(acc[i], 26));
+    }
+
+    __m256i carry = zero;
+
+    for (uint32_t i = n; i < 2 * n; i++)
+    {
+        __m256i column = _mm256_add_epi64(acc[i], carry);
+
+        carry = _mm256_srli_epi64(column, 26);
+        _mm256_store_si256((__m256i *)(out + (i - n) * 4), _mm256_and_si256(column, mask));
+    }
+}
+
+/**
+ * @brief out = a^2 / R mod N on 4 lanes of radix 2^26 digits.
+ *
+ * Without a split multiply-add the square is worth computing apart: each cross product is
+ * computed once and doubled, then the columns are reduced by N as in `simd_mont_mul_avx2`.
+ * This takes 1.5 * digits^2 products instead of 2 * digits^2.
+ */
+__attribute__((target("avx2"))) static void simd_mont_sqr_avx2(const simd_mont_t *m, uint64_t *out, const uint64_t *a)
+{
+    const uint32_t n = m->digits;
+    __m256i acc[2 * SIMD_MONT_MAX_DIGITS + 1];
+
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i mask = _mm256_set1_epi64x(m->mask);
+    const __m256i ninv = _mm256_set1_epi64x(m->ninv);
+
+    for (uint32_t i = 0; i <= 2 * n; i++)
+    {
+        acc[i] = zero;
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const __m256i ai = _mm256_load_si256((const __m256i *)(a + i * 4));
+
+        for (uint32_t j = i + 1; j < n; j++)
+        {
+            const __m256i aj = _mm256_load_si256((const __m256i *)(a + j * 4));
+
+            acc[i + j] = _mm256_add_epi64(acc[i + j], _mm256_mul_epu32(ai, aj));
+        }
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const __m256i ai = _mm256_load_si256((const __m256i *)(a + i * 4));
+
+        acc[2 * i] = _mm256_add_epi64(_mm256_slli_epi64(acc[2 * i], 1), _mm256_mul_epu32(ai, ai));
+        acc[2 * i + 1] = _mm256_slli_epi64(acc[2 * i + 1], 1);
+    }
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        const __m256i q = _mm256_and_si256(_mm256_mul_epu32(_mm256_and_si256(acc[i], mask), ninv), mask);
+
+        for (uint32_t j = 0; j < n; j++)
+        {
+            const __m256i nj = _mm256_load_si256((const __m256i *)(m->N + j * 4));
+
+            acc[i + j] = _mm256_add_epi64(acc[i + j], _mm256_mul_epu32(nj, q));
+        }
+
+        acc[i + 1] = _mm256_add_epi64(acc[i + 1], _mm256_srli_epi64(acc[i], 26));
+    }
+
+    __m256i carry = zero;
+
+    for (uint32_t i = n; i < 2 * n; i++)
+    {
+        __m256i column = _mm256_add_epi64(acc[i], carry);
+
+        carry = _mm256_srli_epi64(column, 26);
+        _mm256_store_si256((__m256i *)(out + (i - n) * 4), _mm256_and_si256(column, mask));
+    }
+}
+
+static inline void simd_mont_mul(const simd_mont_t *m, uint64_t *out, const uint64_t *a, const uint64_t *b)
+{
+    if (m->isa == SIMD_MONT_AVX512_IFMA)
+        simd_mont_mul_ifma(m, out, a, b);
+    else
+        simd_mont_mul_avx2(m, out, a, b);
+}
+
+static inline void simd_mont_sqr(const simd_mont_t *m, uint64_t *x)
+{
+    if (m->isa == SIMD_MONT_AVX512_IFMA)
+        simd_mont_mul_ifma(m, x, x, x);
+    else
+        simd_mont_sqr_avx2(m, x, x);
+}
+
+// spreads the digits of x (below 2^(bits * digits)) on one lane
+static void simd_mont_load(const simd_mont_t *m, uint64_t *dst, uint32_t lane, const mpz_t x)
+{
+    const mp_limb_t *limbs = mpz_limbs_read(x);
+    const uint32_t size = mpz_size(x);
+
+    for (uint32_t i = 0; i < m->digits; i++)
+    {
+        uint32_t bit = i * m->bits;
+        uint32_t limb = bit / GMP_NUMB_BITS;
+        uint32_t offset = bit % GMP_NUMB_BITS;
+        uint64_t digit = 0;
+
+        if (limb < size)
+            digit = limbs[limb] >> offset;
+
+        if (offset + m->bits > GMP_NUMB_BITS && limb + 1 < size)
+            digit |= limbs[limb + 1] << (GMP_NUMB_BITS - offset);
+
+        dst[i * m->lanes + lane] = digit & m->mask;
+    }
+}
+
+// gathers the normalized digits of one lane back into x
+static void simd_mont_store(const simd_mont_t *m, mpz_t x, const uint64_t *src, uint32_t lane)
+{
+    const uint32_t size = (m->digits * m->bits + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+    mp_limb_t *limbs = mpz_limbs_write(x, size);
+
+    mpn_zero(limbs, size);
+
+    for (uint32_t i = 0; i < m->digits; i++)
+    {
+        uint64_t digit = src[i * m->lanes + lane];
+        uint32_t bit = i * m->bits;
+        uint32_t limb = bit / GMP_NUMB_BITS;
+        uint32_t offset = bit % GMP_NUMB_BITS;
+
+        limbs[limb] |= digit << offset;
+
+        if (offset + m->bits > GMP_NUMB_BITS)
+            limbs[limb + 1] |= digit >> (GMP_NUMB_BITS - offset);
+    }
+
+    mpz_limbs_finish(x, size);
+}
+
+static void simd_mont_spread(const simd_mont_t *m, uint64_t *dst, const mpz_t x)
+{
+    for (uint32_t k = 0; k < m->lanes; k++)
+    {
+        simd_mont_load(m, dst, k, x);
+    }
+}
+
+static simd_mont_t *simd_mont_get(simd_mont_isa_t isa, const mpz_t N)
+{
+    simd_mont_t *m = &simd_mont_cache;
+    uint32_t size = mpz_size(N);
+
+    if (m->isa == isa && m->size == size && mpn_cmp(m->key, mpz_limbs_read(N), size) == 0)
+        return m;
+
+    m->isa = isa;
+    m->lanes = simd_mont_lanes(isa);
+    m->bits = isa == SIMD_MONT_AVX512_IFMA ? 52 : 26;
+    m->digits = (mpz_sizeinbase(N, 2) + 2 + m->bits - 1) / m->bits;
+    m->mask = ((uint64_t)1 << m->bits) - 1;
+
+    m->size = size;
+    mpn_copyi(m->key, mpz_limbs_read(N), size);
+
+    // Newton iteration for 1/N mod 2^64
+    uint64_t n0 = mpz_getlimbn(N, 0);
+    uint64_t inverse = n0;
+
+    for (uint32_t i = 0; i < 6; i++)
+    {
+        inverse *= 2 - n0 * inverse;
+    }
+
+    m->ninv = (0 - inverse) & m->mask;
+
+    mpz_t power;
+    mpz_init(power);
+
+    simd_mont_spread(m, m->N, N);
+
+    mpz_setbit(power, 2 * m->digits * m->bits);
+    mpz_mod(power, power, N);
+    simd_mont_spread(m, m->R2, power);
+
+    mpz_set_ui(power, 1);
+    simd_mont_spread(m, m->one, power);
+
+    mpz_clear(power);
+
+    return m;
+}
+
+uint8_t simd_mont_square_batch(mpz_t *values, uint32_t count, uint32_t squarings, const mpz_t N)
+{
+    simd_mont_isa_t isa = simd_mont_isa();
+
+    if (isa == SIMD_MONT_NONE || mpz_even_p(N) || mpz_sizeinbase(N, 2) > SIMD_MONT_MAX_BITS)
+        return 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (mpz_sgn(values[i]) < 0 || mpz_cmp(values[i], N) >= 0)
+            return 0;
+    }
+
+    simd_mont_t *m = simd_mont_get(isa, N);
+
+    for (uint32_t first = 0; first < count; first += m->lanes)
+    {
+        uint32_t used = count - first < m->lanes ? count - first : m->lanes;
+
+        // unused lanes square zero
+        memset(m->x, 0, m->digits * m->lanes * sizeof(uint64_t));
+
+        for (uint32_t k = 0; k < used; k++)
+        {
+            simd_mont_load(m, m->x, k, values[first + k]);
+        }
+
+        simd_mont_mul(m, m->x, m->x, m->R2);
+
+        for (uint32_t s = 0; s < squarings; s++)
+        {
+            simd_mont_sqr(m, m->x);
+        }
+
+        // out of Montgomery form the lanes are at most N
+        simd_mont_mul(m, m->x, m->x, m->one);
+
+        for (uint32_t k = 0; k < used; k++)
+        {
+            simd_mont_store(m, values[first + k], m->x, k);
+
+            if (mpz_cmp(values[first + k], N) >= 0)
+                mpz_sub(values[first + k], values[first + k], N);
+        }
+    }
+
+    return 1;
+}
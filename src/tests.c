@@ -1,10 +1,15 @@
 #include "../include/tests.h"
+#include "../include/runtime.h"
+#include "../include/session.h"
+#include "../include/evolver.h"
 
 void init_test(context_t *ctx, public_key_t *PK, player_t **players, const char *test_name)
 {
     printf("[%s] Test started\n", test_name);
 
-    gmp_randinit_default(ctx->prng);
+    alloc_profiler_begin();
+
+    random_init(ctx->prng, RANDOM_BACKEND_DEFAULT);
     gmp_randseed_os_rng(ctx->prng, 128);
 
     *players = (player_t *)malloc(ctx->n * sizeof(player_t));
@@ -12,11 +17,16 @@ void init_test(context_t *ctx, public_key_t *PK, player_t **players, const char
 
 void end_test(context_t *ctx, public_key_t *PK, player_t *players, const char *test_name)
 {
+    alloc_profile_t profile;
+
     printf("[%s] Test passed\n", test_name);
 
     gmp_randclear(ctx->prng);
 
     cleanup(ctx, PK, players);
+
+    alloc_profiler_end(&profile);
+    printf_alloc_profile(test_name, &profile);
 }
 
 void test_simple_sign_verify()
@@ -81,7 +91,7 @@ void test_round_update_sign_verify()
     end_test(&protocol_parameters, &PK, players, __func__);
 }
 
-void test_forge_sign_verify()
+void test_update_to_sign_verify()
 {
     context_t protocol_parameters;
     public_key_t PK;
@@ -97,23 +107,207 @@ void test_forge_sign_verify()
 
     keygen(&protocol_parameters, &PK, players);
 
+    update(&protocol_parameters, &PK, players, 0);
+
+    assert(update_to(&protocol_parameters, &PK, players, 4) == 1);
+    assert(update_to(&protocol_parameters, &PK, players, 2) == 0);
+    assert(update_to(&protocol_parameters, &PK, players, protocol_parameters.T + 1) == 0);
+
     const char *m = __func__;
 
-    signature_t *signature = sign(&protocol_parameters, &PK, players, m, 0);
+    signature_t *signature = sign(&protocol_parameters, &PK, players, m, 3);
 
-    const char *fake_m = "fake message";
+    assert(verify(&protocol_parameters, &PK, m, signature) == 0);
+
+    signature_free(signature);
+
+    signature = sign(&protocol_parameters, &PK, players, m, 4);
 
     assert(verify(&protocol_parameters, &PK, m, signature) == 1);
-    assert(verify(&protocol_parameters, &PK, fake_m, signature) == 0);
 
     signature_free(signature);
 
     end_test(&protocol_parameters, &PK, players, __func__);
 }
 
+void test_runtime_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    const char *m = __func__;
+
+    runtime_t *rt = runtime_new(&protocol_parameters, &PK, players, TRANSPORT_QUEUE);
+
+    signature_t *signature = runtime_sign(rt, m, 0);
+
+    assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+    assert(rt->stats.rounds > 0);
+    assert(rt->stats.messages == rt->stats.rounds * protocol_parameters.n * (protocol_parameters.n - 1));
+
+    signature_free(signature);
+
+    assert(runtime_update(rt, 0) == 1);
+
 #ifndef USE_POLYNOMIAL
+    runtime_refresh(rt);
 
-void test_refresh_sign_verify()
+    // every node keeps its verification keys in step with its refreshed shares
+    mpz_t key;
+    mpz_init(key);
+
+    for (uint32_t p = 0; p < protocol_parameters.n; p++)
+    {
+        for (uint32_t i = 0; i < protocol_parameters.l; i++)
+        {
+            mpz_set(key, players[p].sk.S[i]);
+            mpz_double_pow(key, PK.T, players[p].sk.j, PK.N);
+
+            assert(mpz_cmp(key, PK.V[p * protocol_parameters.l + i]) == 0);
+        }
+    }
+
+    mpz_clear(key);
+#endif
+
+    runtime_free(rt);
+
+    rt = runtime_new(&protocol_parameters, &PK, players, TRANSPORT_SOCKET);
+
+    signature = runtime_sign(rt, m, 1);
+
+    assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+
+    signature_free(signature);
+
+    runtime_free(rt);
+
+    rt = runtime_new(&protocol_parameters, &PK, players, TRANSPORT_SHM);
+
+    signature = runtime_sign(rt, m, 1);
+
+    assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+
+    signature_free(signature);
+
+    runtime_free(rt);
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+// larger than the channel buffers of the socket and shared-memory transports
+#define TEST_TRANSPORT_MESSAGE_SIZE (1 << 20)
+#define TEST_TRANSPORT_PARTIES 3
+#define TEST_TRANSPORT_ROUNDS 2
+
+typedef struct
+{
+    transport_t *transport;
+    uint32_t id;
+    uint8_t ok;
+} test_transport_party_t;
+
+static uint8_t test_transport_byte(uint32_t round, uint32_t from, uint32_t to, size_t i)
+{
+    return (uint8_t)(i * 131 + round * 17 + from * 7 + to);
+}
+
+/**
+ * @brief One party of the transport test: every round it sends to all the others before receiving.
+ */
+static void *test_transport_thread(void *arg)
+{
+    test_transport_party_t *party = (test_transport_party_t *)arg;
+    size_t len;
+
+    uint8_t *message = (uint8_t *)malloc(TEST_TRANSPORT_MESSAGE_SIZE);
+    check_null_pointer(message);
+
+    party->ok = 1;
+
+    for (uint32_t round = 0; round < TEST_TRANSPORT_ROUNDS; round++)
+    {
+        for (uint32_t k = 0; k < TEST_TRANSPORT_PARTIES; k++)
+        {
+            if (k == party->id)
+                continue;
+
+            for (size_t i = 0; i < TEST_TRANSPORT_MESSAGE_SIZE; i++)
+            {
+                message[i] = test_transport_byte(round, party->id, k, i);
+            }
+
+            transport_send(party->transport, party->id, k, message, TEST_TRANSPORT_MESSAGE_SIZE);
+        }
+
+        for (uint32_t k = 0; k < TEST_TRANSPORT_PARTIES; k++)
+        {
+            if (k == party->id)
+                continue;
+
+            uint8_t *data = transport_recv(party->transport, party->id, k, &len);
+
+            party->ok &= len == TEST_TRANSPORT_MESSAGE_SIZE;
+
+            for (size_t i = 0; i < len; i++)
+            {
+                party->ok &= data[i] == test_transport_byte(round, k, party->id, i);
+            }
+
+            free(data);
+        }
+    }
+
+    free(message);
+
+    return NULL;
+}
+
+void test_transport_large_messages()
+{
+    const transport_kind_t kinds[] = {TRANSPORT_QUEUE, TRANSPORT_SOCKET, TRANSPORT_SHM};
+
+    pthread_t threads[TEST_TRANSPORT_PARTIES];
+    test_transport_party_t parties[TEST_TRANSPORT_PARTIES];
+
+    printf("[%s] Test started\n", __func__);
+
+    for (uint32_t t = 0; t < sizeof(kinds) / sizeof(kinds[0]); t++)
+    {
+        transport_t *transport = transport_new(kinds[t], TEST_TRANSPORT_PARTIES);
+
+        for (uint32_t i = 0; i < TEST_TRANSPORT_PARTIES; i++)
+        {
+            parties[i] = (test_transport_party_t){transport, i, 0};
+            pthread_create(&threads[i], NULL, test_transport_thread, &parties[i]);
+        }
+
+        for (uint32_t i = 0; i < TEST_TRANSPORT_PARTIES; i++)
+        {
+            pthread_join(threads[i], NULL);
+            assert(parties[i].ok == 1);
+        }
+
+        assert(atomic_load(&transport->messages) == TEST_TRANSPORT_ROUNDS * TEST_TRANSPORT_PARTIES * (TEST_TRANSPORT_PARTIES - 1));
+
+        transport_free(transport);
+    }
+
+    printf("[%s] Test passed\n", __func__);
+}
+
+void test_sign_batch_verify()
 {
     context_t protocol_parameters;
     public_key_t PK;
@@ -129,20 +323,1214 @@ void test_refresh_sign_verify()
 
     keygen(&protocol_parameters, &PK, players);
 
-    const char *m = __func__;
+    const char *msgs[] = {__func__, "second message", "", "fourth message"};
+    const uint32_t count = sizeof(msgs) / sizeof(msgs[0]);
 
-    refresh(&protocol_parameters, &PK, players);
+    signature_t signatures[count];
 
-    signature_t *signature = sign(&protocol_parameters, &PK, players, m, 0);
+    sign_batch(&protocol_parameters, &PK, players, msgs, count, 0, signatures);
 
-    const char *fake_m = "fake message";
+    for (uint32_t k = 0; k < count; k++)
+    {
+        assert(verify(&protocol_parameters, &PK, msgs[k], &signatures[k]) == 1);
+        assert(verify(&protocol_parameters, &PK, msgs[(k + 1) % count], &signatures[k]) == 0);
+
+        signature_clear(&signatures[k]);
+    }
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+#define TEST_SESSIONS 4
+#define TEST_SESSION_SIGNATURES 8
+
+typedef struct
+{
+    context_t *ctx;
+    public_key_t *pk;
+    player_t *players;
+    uint8_t ok;
+} test_session_t;
+
+static void *test_session_thread(void *arg)
+{
+    test_session_t *test = (test_session_t *)arg;
+
+    session_t *session = session_new(test->ctx, test->pk, test->players);
+
+    test->ok = 1;
+
+    for (uint32_t i = 0; i < TEST_SESSION_SIGNATURES; i++)
+    {
+        signature_t *signature = session_sign(session, __func__, 0);
+
+        test->ok &= session_verify(session, __func__, signature) == 1;
+        test->ok &= session_verify(session, "fake message", signature) == 0;
+
+        signature_free(signature);
+    }
+
+    session_free(session);
+
+    return NULL;
+}
+
+void test_concurrent_sessions_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    pthread_t threads[TEST_SESSIONS];
+    test_session_t sessions[TEST_SESSIONS];
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    for (uint32_t i = 0; i < TEST_SESSIONS; i++)
+    {
+        sessions[i] = (test_session_t){&protocol_parameters, &PK, players, 0};
+        pthread_create(&threads[i], NULL, test_session_thread, &sessions[i]);
+    }
+
+    for (uint32_t i = 0; i < TEST_SESSIONS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        assert(sessions[i].ok == 1);
+    }
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+#define TEST_RANDOM_VALUES 64
+
+void test_random_backends_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    const random_backend_t backends[] = {RANDOM_BACKEND_MT, RANDOM_BACKEND_CHACHA};
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    for (uint32_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++)
+    {
+        init_test(&protocol_parameters, &PK, &players, __func__);
+
+        gmp_randclear(protocol_parameters.prng);
+        random_init(protocol_parameters.prng, backends[b]);
+        gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+        assert(random_backend(protocol_parameters.prng) == backends[b]);
+
+        keygen(&protocol_parameters, &PK, players);
+
+        // a copy of the state continues the same stream
+        gmp_randstate_t copy;
+        gmp_randinit_set(copy, protocol_parameters.prng);
+
+        mpz_t values[TEST_RANDOM_VALUES], copies[TEST_RANDOM_VALUES];
+
+        for (uint32_t i = 0; i < TEST_RANDOM_VALUES; i++)
+        {
+            mpz_inits(values[i], copies[i], NULL);
+        }
+
+        mpz_urandomm_array(values, TEST_RANDOM_VALUES, protocol_parameters.prng, PK.N);
+        mpz_urandomm_array(copies, TEST_RANDOM_VALUES, copy, PK.N);
+
+        for (uint32_t i = 0; i < TEST_RANDOM_VALUES; i++)
+        {
+            assert(mpz_cmp(values[i], copies[i]) == 0);
+            assert(mpz_sgn(values[i]) >= 0 && mpz_cmp(values[i], PK.N) < 0);
+
+            mpz_clears(values[i], copies[i], NULL);
+        }
+
+        gmp_randclear(copy);
+
+        const char *m = __func__;
+
+        signature_t *signature = sign(&protocol_parameters, &PK, players, m, 0);
+
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+
+        signature_free(signature);
+
+        end_test(&protocol_parameters, &PK, players, __func__);
+    }
+}
+
+#define TEST_FIXED_LIMB_VALUES 16
+
+void test_fixed_limb_consistency()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+
+    const uint32_t sizes[] = {1024, 2048};
+
+    printf("[%s] Test started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    protocol_parameters.l = 160;
+
+    mpz_t values[TEST_FIXED_LIMB_VALUES], expected[TEST_FIXED_LIMB_VALUES];
+    mpz_t exponent;
+    mpz_init(exponent);
+
+    uint8_t c[160];
+
+    for (uint32_t i = 0; i < TEST_FIXED_LIMB_VALUES; i++)
+    {
+        mpz_inits(values[i], expected[i], NULL);
+    }
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        protocol_parameters.k = sizes[s];
+
+        dealer_init_modulo(&protocol_parameters, &PK);
+
+        assert(fixed_limb_get(PK.N) != NULL);
+
+        mpz_urandomm_array(values, TEST_FIXED_LIMB_VALUES, protocol_parameters.prng, PK.N);
+
+        // squaring chains against mpz_powm by 2^10
+        mpz_set_ui(exponent, 0);
+        mpz_setbit(exponent, 10);
+
+        for (uint32_t i = 0; i < TEST_FIXED_LIMB_VALUES; i++)
+        {
+            mpz_powm(expected[i], values[i], exponent, PK.N);
+        }
+
+        assert(fixed_limb_double_pow_batch(values, TEST_FIXED_LIMB_VALUES, 10, PK.N) == 1);
+
+        for (uint32_t i = 0; i < TEST_FIXED_LIMB_VALUES; i++)
+        {
+            assert(mpz_cmp(values[i], expected[i]) == 0);
+        }
+
+        // products of selected keys against mpz_mul and mpz_mod
+        for (uint32_t i = 0; i < protocol_parameters.l; i++)
+        {
+            c[i] = gmp_urandomb_ui(protocol_parameters.prng, 1);
+        }
+
+        mpz_set(expected[0], values[0]);
+
+        for (uint32_t i = 0; i < protocol_parameters.l; i++)
+        {
+            if (c[i] == 0)
+                continue;
+
+            mpz_mul(expected[0], expected[0], values[i % TEST_FIXED_LIMB_VALUES]);
+            mpz_mod(expected[0], expected[0], PK.N);
+        }
+
+        mpz_t *keys = (mpz_t *)malloc(protocol_parameters.l * sizeof(mpz_t));
+        check_null_pointer(keys);
+
+        for (uint32_t i = 0; i < protocol_parameters.l; i++)
+        {
+            mpz_init_set(keys[i], values[i % TEST_FIXED_LIMB_VALUES]);
+        }
+
+        assert(fixed_limb_mmul_pow_array(expected[1], values[0], c, (const mpz_t *)keys, protocol_parameters.l, PK.N) == 1);
+        assert(mpz_cmp(expected[0], expected[1]) == 0);
+
+        for (uint32_t i = 0; i < protocol_parameters.l; i++)
+        {
+            mpz_clear(keys[i]);
+        }
+
+        free(keys);
+
+        // unsupported sizes are left to mpz
+        mpz_nextprime(exponent, exponent);
+        assert(fixed_limb_get(exponent) == NULL);
+
+        mpz_clear(PK.N);
+    }
+
+    for (uint32_t i = 0; i < TEST_FIXED_LIMB_VALUES; i++)
+    {
+        mpz_clears(values[i], expected[i], NULL);
+    }
+
+    mpz_clear(exponent);
+    gmp_randclear(protocol_parameters.prng);
+
+    printf("[%s] Test passed\n", __func__);
+}
+
+#define TEST_SIMD_MONT_VALUES 11
+#define TEST_SIMD_MONT_SQUARINGS 7
+
+void test_simd_mont_consistency()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+
+    const uint32_t sizes[] = {1024, 2048};
+    const simd_mont_isa_t isas[] = {SIMD_MONT_AVX2, SIMD_MONT_AVX512_IFMA};
+    const simd_mont_isa_t best = simd_mont_isa();
+
+    printf("[%s] Test started\n", __func__);
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    mpz_t values[TEST_SIMD_MONT_VALUES], expected[TEST_SIMD_MONT_VALUES];
+    mpz_t exponent;
+    mpz_init(exponent);
+    mpz_setbit(exponent, TEST_SIMD_MONT_SQUARINGS);
+
+    for (uint32_t i = 0; i < TEST_SIMD_MONT_VALUES; i++)
+    {
+        mpz_inits(values[i], expected[i], NULL);
+    }
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        protocol_parameters.k = sizes[s];
+
+        dealer_init_modulo(&protocol_parameters, &PK);
+
+        for (uint32_t k = 0; k < sizeof(isas) / sizeof(isas[0]); k++)
+        {
+            if (simd_mont_set_isa(isas[k]) != isas[k])
+                continue;
+
+            // a partial group of lanes, with the edge values 0, 1 and N - 1
+            mpz_urandomm_array(values, TEST_SIMD_MONT_VALUES, protocol_parameters.prng, PK.N);
+            mpz_set_ui(values[0], 0);
+            mpz_set_ui(values[1], 1);
+            mpz_sub_ui(values[2], PK.N, 1);
+
+            for (uint32_t i = 0; i < TEST_SIMD_MONT_VALUES; i++)
+            {
+                mpz_powm(expected[i], values[i], exponent, PK.N);
+            }
+
+            assert(simd_mont_square_batch(values, TEST_SIMD_MONT_VALUES, TEST_SIMD_MONT_SQUARINGS, PK.N) == 1);
+
+            for (uint32_t i = 0; i < TEST_SIMD_MONT_VALUES; i++)
+            {
+                assert(mpz_cmp(values[i], expected[i]) == 0);
+            }
+        }
+
+        mpz_clear(PK.N);
+    }
+
+    simd_mont_set_isa(best);
+
+    for (uint32_t i = 0; i < TEST_SIMD_MONT_VALUES; i++)
+    {
+        mpz_clears(values[i], expected[i], NULL);
+    }
+
+    mpz_clear(exponent);
+    gmp_randclear(protocol_parameters.prng);
+
+    printf("[%s] Test passed\n", __func__);
+}
+
+void test_key_store_layout()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 32;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    key_store_t *store = players[0].sk.store;
+    uint32_t total = protocol_parameters.n * protocol_parameters.l;
+
+    assert(store->count == total);
+    assert(store->stride > mpz_size(PK.N));
+    assert((uintptr_t)store->limbs % KEY_STORE_ALIGNMENT == 0);
+    assert(store->stride * sizeof(mp_limb_t) % KEY_STORE_ALIGNMENT == 0);
+
+    // the rows of the players follow each other in the slab
+    for (uint32_t i = 0; i < protocol_parameters.n; i++)
+    {
+        assert(players[i].sk.store == store);
+
+        for (uint32_t j = 0; j < protocol_parameters.l; j++)
+        {
+            assert(players[i].sk.S[j]->_mp_d == store->limbs + (size_t)(i * protocol_parameters.l + j) * store->stride);
+            assert(key_store_at(store, i, protocol_parameters.l, j) == players[i].sk.S[j]);
+        }
+    }
+
+#ifndef USE_POLYNOMIAL
+    mpz_t *expected = (mpz_t *)malloc(total * sizeof(mpz_t));
+    check_null_pointer(expected);
+
+    for (uint32_t i = 0; i < total; i++)
+    {
+        mpz_init(expected[i]);
+        mpz_powm_ui(expected[i], store->views[i], 4, PK.N);
+    }
+#endif
+
+    // key evolution never moves a share out of its slot
+    update(&protocol_parameters, &PK, players, 0);
+    update_to(&protocol_parameters, &PK, players, 2);
+
+    for (uint32_t i = 0; i < total; i++)
+    {
+        assert(store->views[i]->_mp_d == store->limbs + (size_t)i * store->stride);
+    }
+
+#ifndef USE_POLYNOMIAL
+    // the multiplicative shares are squared in place
+    for (uint32_t i = 0; i < total; i++)
+    {
+        assert(mpz_cmp(store->views[i], expected[i]) == 0);
+        mpz_clear(expected[i]);
+    }
+
+    free(expected);
+#endif
+
+    const char *m = __func__;
+    signature_t *signature = sign(&protocol_parameters, &PK, players, m, 2);
 
     assert(verify(&protocol_parameters, &PK, m, signature) == 1);
-    assert(verify(&protocol_parameters, &PK, fake_m, signature) == 0);
 
     signature_free(signature);
 
     end_test(&protocol_parameters, &PK, players, __func__);
 }
 
+void test_shamir_consistency()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+
+    const uint32_t sizes[] = {5, 64};
+
+    printf("[%s] Test started\n", __func__);
+
+    protocol_parameters.k = 1024;
+
+    random_init(protocol_parameters.prng, RANDOM_BACKEND_DEFAULT);
+    gmp_randseed_os_rng(protocol_parameters.prng, 128);
+
+    dealer_init_modulo(&protocol_parameters, &PK);
+
+    mpz_t a, b, expected, result, point;
+    mpz_inits(a, b, expected, result, point, NULL);
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        uint32_t n = sizes[s], t = (n + 1) / 2;
+
+        mpz_point_t *shares_a = (mpz_point_t *)malloc(n * sizeof(mpz_point_t));
+        check_null_pointer(shares_a);
+
+        mpz_point_t *shares_b = (mpz_point_t *)malloc(n * sizeof(mpz_point_t));
+        check_null_pointer(shares_b);
+
+        mpz_point_t *product = (mpz_point_t *)malloc(n * sizeof(mpz_point_t));
+        check_null_pointer(product);
+
+        mpz_urandomm(a, protocol_parameters.prng, PK.N);
+        mpz_urandomm(b, protocol_parameters.prng, PK.N);
+
+        shamir_ss(shares_a, n, a, t, protocol_parameters.prng, PK.N);
+        shamir_ss(shares_b, n, b, t, protocol_parameters.prng, PK.N);
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            mpz_inits(product[i].x, product[i].y, NULL);
+        }
+
+        // at zero the secret, at an abscissa of the shares that share
+        mpz_set_ui(point, 0);
+        lagrange_interpolation(result, shares_a, point, n, PK.N);
+        assert(mpz_cmp(result, a) == 0);
+
+        mpz_set_ui(point, n);
+        lagrange_interpolation(result, shares_a, point, n, PK.N);
+        assert(mpz_cmp(result, shares_a[n - 1].y) == 0);
+
+        // both resharings give sharings of the same product
+        mpz_mul(expected, a, b);
+        mpz_mod(expected, expected, PK.N);
+
+        mpz_set_ui(point, 0);
+
+        mult_shamir_ss(product, shares_a, shares_b, n, t, protocol_parameters.prng, PK.N);
+        lagrange_interpolation(result, product, point, t, PK.N);
+        assert(mpz_cmp(result, expected) == 0);
+
+        mult_shamir_ss_batch_reshare(&product, &shares_a, &shares_b, 1, n, t, protocol_parameters.prng, PK.N);
+        lagrange_interpolation(result, product, point, t, PK.N);
+        assert(mpz_cmp(result, expected) == 0);
+
+        for (uint32_t i = 0; i < n; i++)
+        {
+            mpz_clear_point(shares_a[i]);
+            mpz_clear_point(shares_b[i]);
+            mpz_clear_point(product[i]);
+        }
+
+        free(shares_a);
+        free(shares_b);
+        free(product);
+    }
+
+    mpz_clears(a, b, expected, result, point, PK.N, NULL);
+    gmp_randclear(protocol_parameters.prng);
+
+    printf("[%s] Test passed\n", __func__);
+}
+
+void test_sign_quorum_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+    quorum_t quorum;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 9;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    const char *m = __func__;
+
+#ifdef USE_POLYNOMIAL
+    // quorums of 2t - 1 players, with the cached coefficients on the second use of each
+    const uint64_t masks[] = {0x01f, 0x1f0, 0x155, 0x01f};
+#else
+    const uint64_t masks[] = {0x1ff};
+#endif
+
+    for (uint32_t i = 0; i < sizeof(masks) / sizeof(masks[0]); i++)
+    {
+        quorum_init_mask(&quorum, masks[i]);
+
+        signature_t *signature = sign_quorum(&protocol_parameters, &PK, players, &quorum, m, 0);
+
+        assert(signature != NULL);
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+
+        signature_free(signature);
+    }
+
+    quorum_init_mask(&quorum, 0x01f);
+    assert(quorum_lagrange_at_zero(&quorum, PK.N) == quorum_lagrange_at_zero(&quorum, PK.N));
+
+    // too few players, and a player that does not exist
+    quorum_init_mask(&quorum, 0x00f);
+    assert(sign_quorum(&protocol_parameters, &PK, players, &quorum, m, 0) == NULL);
+
+    quorum_init_mask(&quorum, 0x3ff);
+    assert(sign_quorum(&protocol_parameters, &PK, players, &quorum, m, 0) == NULL);
+
+    quorum_cache_clear();
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+#define TEST_BEAVER_CAPACITY 4
+#define TEST_BEAVER_MULTIPLICATIONS 10
+
+void test_beaver_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 60;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    // a small pool, so that the multiplications outrun the producer
+    beaver_pool_t *pool = beaver_pool_new(&protocol_parameters, &PK, TEST_BEAVER_CAPACITY);
+
+    mpz_point_t *x = (mpz_point_t *)malloc(protocol_parameters.n * sizeof(mpz_point_t));
+    check_null_pointer(x);
+
+    mpz_point_t *y = (mpz_point_t *)malloc(protocol_parameters.n * sizeof(mpz_point_t));
+    check_null_pointer(y);
+
+    mpz_t a, b, expected, result;
+    mpz_inits(a, b, expected, result, NULL);
+
+    mpz_urandomm(a, protocol_parameters.prng, PK.N);
+    mpz_urandomm(b, protocol_parameters.prng, PK.N);
+
+    shamir_ss(x, protocol_parameters.n, a, protocol_parameters.threshold, protocol_parameters.prng, PK.N);
+    shamir_ss(y, protocol_parameters.n, b, protocol_parameters.threshold, protocol_parameters.prng, PK.N);
+
+    mpz_set(expected, a);
+
+    for (uint32_t i = 0; i < TEST_BEAVER_MULTIPLICATIONS; i++)
+    {
+        beaver_mult(pool, x, x, x);
+        beaver_mult(pool, x, x, y);
+
+        mpz_mul(expected, expected, expected);
+        mpz_mul(expected, expected, b);
+        mpz_mod(expected, expected, PK.N);
+
+        beaver_open(pool, result, x);
+        assert(mpz_cmp(result, expected) == 0);
+    }
+
+    for (uint32_t i = 0; i < protocol_parameters.n; i++)
+    {
+        mpz_clear_point(x[i]);
+        mpz_clear_point(y[i]);
+    }
+
+    free(x);
+    free(y);
+
+    mpz_clears(a, b, expected, result, NULL);
+
+#ifdef USE_POLYNOMIAL
+    const char *m = __func__;
+
+    for (uint32_t j = 0; j < 3; j++)
+    {
+        signature_t *signature = sign_beaver(&protocol_parameters, &PK, players, pool, m, j);
+
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+        assert(verify(&protocol_parameters, &PK, "fake message", signature) == 0);
+
+        signature_free(signature);
+
+        update(&protocol_parameters, &PK, players, j);
+    }
+#endif
+
+    beaver_pool_free(pool);
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+#define TEST_PACKED_SQUARINGS 3
+
+void test_packed_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 61;
+    protocol_parameters.n = 9;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    uint32_t factor = packed_max_factor(protocol_parameters.n, protocol_parameters.threshold);
+
+    assert(factor == 3);
+    assert(!packed_fits(protocol_parameters.n, protocol_parameters.threshold, factor + 1));
+
+#ifdef USE_POLYNOMIAL
+    assert(keygen_packed(&protocol_parameters, &PK, players, factor + 1) == 0);
+    assert(keygen_packed(&protocol_parameters, &PK, players, factor) == 1);
+
+    // 61 components in packs of 3, the last one with a single component
+    assert(players[0].sk.store->count == protocol_parameters.n * 21);
+#else
+    keygen(&protocol_parameters, &PK, players);
+#endif
+
+    packed_t *packing = packed_get(protocol_parameters.n, protocol_parameters.threshold, factor, PK.N);
+
+    mpz_t values[PACKED_MAX_FACTOR], expected[PACKED_MAX_FACTOR];
+    mpz_t *shares = (mpz_t *)malloc(protocol_parameters.n * sizeof(mpz_t));
+    check_null_pointer(shares);
+
+    for (uint32_t i = 0; i < protocol_parameters.n; i++)
+    {
+        mpz_init(shares[i]);
+    }
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        mpz_inits(values[s], expected[s], NULL);
+        mpz_urandomm(expected[s], protocol_parameters.prng, PK.N);
+    }
+
+    packed_share(packing, shares, (const mpz_t *)expected, factor, protocol_parameters.prng);
+    packed_open(packing, values, (const mpz_t *)shares);
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        assert(mpz_cmp(values[s], expected[s]) == 0);
+    }
+
+    // a slot unpacked into a plain sharing is recovered at zero by any threshold shares
+    mpz_point_t *unpacked = (mpz_point_t *)malloc(protocol_parameters.n * sizeof(mpz_point_t));
+    check_null_pointer(unpacked);
+
+    for (uint32_t i = 0; i < protocol_parameters.n; i++)
+    {
+        mpz_init_set_ui(unpacked[i].x, i + 1);
+        mpz_init(unpacked[i].y);
+    }
+
+    mpz_t zero;
+    mpz_init(zero);
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        packed_unpack(packing, unpacked, (const mpz_t *)shares, s, protocol_parameters.prng);
+
+        lagrange_interpolation(values[s], unpacked + s, zero, protocol_parameters.threshold, PK.N);
+        assert(mpz_cmp(values[s], expected[s]) == 0);
+    }
+
+    for (uint32_t i = 0; i < protocol_parameters.n; i++)
+    {
+        mpz_clear_point(unpacked[i]);
+    }
+
+    free(unpacked);
+    mpz_clear(zero);
+
+    // every slot of the pack runs its own chain of squarings
+    packed_square(packing, shares, TEST_PACKED_SQUARINGS, protocol_parameters.prng);
+    packed_open(packing, values, (const mpz_t *)shares);
+
+    for (uint32_t s = 0; s < factor; s++)
+    {
+        mpz_double_pow(expected[s], TEST_PACKED_SQUARINGS - 1, 0, PK.N);
+        assert(mpz_cmp(values[s], expected[s]) == 0);
+
+        mpz_clears(values[s], expected[s], NULL);
+    }
+
+    for (uint32_t i = 0; i < protocol_parameters.n; i++)
+    {
+        mpz_clear(shares[i]);
+    }
+
+    free(shares);
+
+#ifdef USE_POLYNOMIAL
+    const char *m = __func__;
+
+    for (uint32_t j = 0; j < 3; j++)
+    {
+        signature_t *signature = sign_packed(&protocol_parameters, &PK, players, m, j);
+
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+        assert(verify(&protocol_parameters, &PK, "fake message", signature) == 0);
+
+        signature_free(signature);
+
+        assert(update_packed(&protocol_parameters, &PK, players, j) == 1);
+    }
+
+    assert(update_packed(&protocol_parameters, &PK, players, protocol_parameters.T) == 0);
+#endif
+
+    packed_cache_clear();
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+void test_seeded_keygen_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 60;
+    protocol_parameters.n = 9;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    provision_t *provision = keygen_seeded(&protocol_parameters, &PK, players);
+
+#ifdef USE_POLYNOMIAL
+    assert(provision->seeded == protocol_parameters.threshold);
+#else
+    assert(provision->seeded == protocol_parameters.n);
+#endif
+
+    assert(provision_size(provision, PK.N) < provision_plain_size(protocol_parameters.n, protocol_parameters.l, PK.N));
+
+    // a seeded player gets the same shares whenever it expands its seed
+    mpz_t *shares = (mpz_t *)malloc(protocol_parameters.l * sizeof(mpz_t));
+    check_null_pointer(shares);
+
+    for (uint32_t i = 0; i < protocol_parameters.l; i++)
+    {
+        mpz_init(shares[i]);
+    }
+
+    provision_expand(provision, provision->seeded - 1, shares, PK.N);
+
+    for (uint32_t i = 0; i < protocol_parameters.l; i++)
+    {
+        assert(mpz_cmp(shares[i], players[provision->seeded - 1].sk.S[i]) == 0);
+        mpz_clear(shares[i]);
+    }
+
+    free(shares);
+
+    const char *m = __func__;
+
+    for (uint32_t j = 0; j < 3; j++)
+    {
+        signature_t *signature = sign(&protocol_parameters, &PK, players, m, j);
+
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+        assert(verify(&protocol_parameters, &PK, "fake message", signature) == 0);
+
+        signature_free(signature);
+
+        update(&protocol_parameters, &PK, players, j);
+    }
+
+    provision_free(provision);
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+void test_verify_parallel_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 2 * VERIFY_PARALLEL_SPLIT_MIN_L;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    const char *m = __func__;
+
+    for (uint32_t j = 0; j < 3; j++)
+    {
+        signature_t *signature = sign(&protocol_parameters, &PK, players, m, j);
+
+        assert(verify_parallel(&protocol_parameters, &PK, m, signature) == 1);
+        assert(verify_parallel(&protocol_parameters, &PK, "fake message", signature) == 0);
+
+        signature_free(signature);
+
+        update(&protocol_parameters, &PK, players, j);
+    }
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+void test_forge_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    const char *m = __func__;
+
+    signature_t *signature = sign(&protocol_parameters, &PK, players, m, 0);
+
+    const char *fake_m = "fake message";
+
+    assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+    assert(verify(&protocol_parameters, &PK, fake_m, signature) == 0);
+
+    signature_free(signature);
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+#define TEST_EVOLVER_SIGNERS 2
+#define TEST_EVOLVER_SIGNATURES 8
+
+typedef struct
+{
+    context_t *ctx;
+    public_key_t *pk;
+    evolver_t *evolver;
+    uint8_t ok;
+} test_evolver_t;
+
+static void *test_evolver_thread(void *arg)
+{
+    test_evolver_t *test = (test_evolver_t *)arg;
+
+    session_t *session = session_new(test->ctx, test->pk, NULL);
+
+    uint32_t period = 0;
+
+    test->ok = 1;
+
+    // the periods go on underneath, each signature is valid for the one it was made in
+    for (uint32_t i = 0; i < TEST_EVOLVER_SIGNATURES; i++)
+    {
+        signature_t *signature = evolver_sign(test->evolver, &session->ctx, __func__);
+
+        test->ok &= signature->j >= period;
+        test->ok &= session_verify(session, __func__, signature) == 1;
+        test->ok &= session_verify(session, "fake message", signature) == 0;
+
+        period = signature->j;
+
+        signature_free(signature);
+    }
+
+    session_free(session);
+
+    return NULL;
+}
+
+void test_evolver_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    pthread_t threads[TEST_EVOLVER_SIGNERS];
+    test_evolver_t signers[TEST_EVOLVER_SIGNERS];
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 4;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    evolver_t *evolver = evolver_new(&protocol_parameters, &PK, players);
+
+    const char *m = __func__;
+
+    // a signer pinning the old period finishes with it, and its unpin wipes it at once
+    player_t *pinned = evolver_acquire(evolver);
+
+    assert(evolver_advance(evolver) == 1);
+    assert(evolver->retired == 1);
+
+    signature_t *old = sign(&protocol_parameters, &PK, pinned, m, pinned[0].sk.j);
+
+    assert(old->j == 0);
+    assert(verify(&protocol_parameters, &PK, m, old) == 1);
+
+    signature_free(old);
+
+    evolver_release(evolver, pinned);
+
+    assert(evolver->retired == 0);
+
+    for (uint32_t i = 0; i < TEST_EVOLVER_SIGNERS; i++)
+    {
+        signers[i] = (test_evolver_t){&protocol_parameters, &PK, evolver, 0};
+        pthread_create(&threads[i], NULL, test_evolver_thread, &signers[i]);
+    }
+
+    for (uint32_t j = 2; j <= protocol_parameters.T; j++)
+    {
+        assert(evolver_advance(evolver) == 1);
+
+        signature_t *signature = evolver_sign(evolver, &protocol_parameters, m);
+
+        assert(signature->j == j);
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+
+        signature_free(signature);
+    }
+
+    assert(evolver_advance(evolver) == 0);
+
+    for (uint32_t i = 0; i < TEST_EVOLVER_SIGNERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        assert(signers[i].ok == 1);
+    }
+
+    assert(evolver->transitions == protocol_parameters.T);
+
+    players = evolver_free(evolver);
+
+    assert(players[0].sk.j == protocol_parameters.T);
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+#ifdef USE_POLYNOMIAL
+
+#define TEST_EVOLVER_PACKING 3
+
+void test_evolver_packed_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 61;
+    protocol_parameters.n = 9;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 4;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    assert(keygen_packed(&protocol_parameters, &PK, players, TEST_EVOLVER_PACKING) == 1);
+
+    evolver_t *evolver = evolver_new(&protocol_parameters, &PK, players);
+
+    const char *m = __func__;
+
+    // the shadow store has the packed layout: the second transition copies it back
+    for (uint32_t j = 1; j <= protocol_parameters.T; j++)
+    {
+        assert(evolver_advance(evolver) == 1);
+
+        signature_t *signature = evolver_sign(evolver, &protocol_parameters, m);
+
+        assert(signature->j == j);
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+
+        signature_free(signature);
+    }
+
+    assert(evolver_advance(evolver) == 0);
+
+    players = evolver_free(evolver);
+
+    assert(players[0].sk.packing == TEST_EVOLVER_PACKING);
+
+    packed_cache_clear();
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+#else
+
+void test_refresh_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    const char *m = __func__;
+
+    refresh(&protocol_parameters, &PK, players);
+
+    signature_t *signature = sign(&protocol_parameters, &PK, players, m, 0);
+
+    const char *fake_m = "fake message";
+
+    assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+    assert(verify(&protocol_parameters, &PK, fake_m, signature) == 0);
+
+    signature_free(signature);
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+void test_distributed_keygen_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 7;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen_distributed(&protocol_parameters, &PK, players);
+
+    // the combined component is the one a dealer would compute from all the shares
+    mpz_t expected;
+    mpz_init_set(expected, PK.U[0]);
+
+    dealer_multiplicative_compute_public_key_i(&protocol_parameters, &PK, players, 0);
+    assert(mpz_cmp(expected, PK.U[0]) == 0);
+
+    mpz_clear(expected);
+
+    const char *m = __func__;
+
+    for (uint32_t j = 0; j < 3; j++)
+    {
+        signature_t *signature = sign(&protocol_parameters, &PK, players, m, j);
+
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+        assert(verify(&protocol_parameters, &PK, "fake message", signature) == 0);
+
+        signature_free(signature);
+
+        refresh(&protocol_parameters, &PK, players);
+        update(&protocol_parameters, &PK, players, j);
+    }
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
+#define TEST_FAULTY_PLAYER 2
+
+void test_partial_verify_sign_verify()
+{
+    context_t protocol_parameters;
+    public_key_t PK;
+    player_t *players;
+
+    protocol_parameters.k = 1024;
+    protocol_parameters.l = 160;
+    protocol_parameters.n = 5;
+    protocol_parameters.threshold = 3;
+    protocol_parameters.T = 10;
+
+    init_test(&protocol_parameters, &PK, &players, __func__);
+
+    keygen(&protocol_parameters, &PK, players);
+
+    const char *m = __func__;
+
+    uint8_t *faulty = (uint8_t *)malloc(protocol_parameters.n);
+    check_null_pointer(faulty);
+
+    mpz_t *shares = (mpz_t *)malloc(protocol_parameters.l * sizeof(mpz_t));
+    check_null_pointer(shares);
+
+    mpz_t product;
+    mpz_init(product);
+
+    for (uint32_t j = 0; j < 3; j++)
+    {
+        signature_t *signature = sign_checked(&protocol_parameters, &PK, players, m, j, faulty);
+
+        assert(signature != NULL);
+        assert(verify(&protocol_parameters, &PK, m, signature) == 1);
+
+        for (uint32_t i = 0; i < protocol_parameters.n; i++)
+        {
+            assert(faulty[i] == 0);
+        }
+
+        signature_free(signature);
+
+        // a player contributing with wrong shares is the only one flagged
+        for (uint32_t i = 0; i < protocol_parameters.l; i++)
+        {
+            mpz_init_set(shares[i], players[TEST_FAULTY_PLAYER].sk.S[i]);
+
+            mpz_mul_2exp(product, shares[i], 1);
+            mpz_mod(players[TEST_FAULTY_PLAYER].sk.S[i], product, PK.N);
+        }
+
+        assert(sign_checked(&protocol_parameters, &PK, players, m, j, faulty) == NULL);
+
+        for (uint32_t i = 0; i < protocol_parameters.n; i++)
+        {
+            assert(faulty[i] == (i == TEST_FAULTY_PLAYER));
+        }
+
+        for (uint32_t i = 0; i < protocol_parameters.l; i++)
+        {
+            mpz_set(players[TEST_FAULTY_PLAYER].sk.S[i], shares[i]);
+            mpz_clear(shares[i]);
+        }
+
+        refresh(&protocol_parameters, &PK, players);
+        update(&protocol_parameters, &PK, players, j);
+
+        // the verification keys still multiply to the public key
+        for (uint32_t i = 0; i < protocol_parameters.l; i++)
+        {
+            mpz_set_ui(product, 1);
+
+            for (uint32_t p = 0; p < protocol_parameters.n; p++)
+            {
+                mpz_mul(product, product, PK.V[p * protocol_parameters.l + i]);
+                mpz_mod(product, product, PK.N);
+            }
+
+            assert(mpz_cmp(product, PK.U[i]) == 0);
+        }
+    }
+
+    mpz_clear(product);
+
+    free(shares);
+    free(faulty);
+
+    end_test(&protocol_parameters, &PK, players, __func__);
+}
+
 #endif
\ No newline at end of file
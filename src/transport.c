@@ -0,0 +1,709 @@
+#include "../include/transport.h"
+#include "../include/utils.h"
+
+#include <errno.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TRANSPORT_SOCKET_BUFFER (1 << 20)
+
+#define TRANSPORT_SHM_RING_SIZE (1 << 18) /* must be a power of two */
+#define TRANSPORT_SHM_SPIN 128
+#define TRANSPORT_SHM_DRAIN_NS 1000000 /* how long a blocked writer sleeps before draining again */
+
+#define TRANSPORT_SPILL_CHUNK (1 << 16)
+
+typedef struct transport_message_s
+{
+    struct transport_message_s *next;
+    size_t len;
+    uint8_t data[];
+} transport_message_t;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    transport_message_t *head;
+    transport_message_t *tail;
+} transport_channel_t;
+
+typedef struct
+{
+    transport_t base;
+    transport_channel_t *channels;
+} transport_queue_t;
+
+/**
+ * @brief Bytes a blocked writer has read ahead from one of its incoming channels.
+ *
+ * A spill is only touched by the receiving party, and `recv` takes from it before the channel.
+ */
+typedef struct
+{
+    uint8_t *data;
+    size_t size;
+    size_t offset;
+    size_t capacity;
+} transport_spill_t;
+
+typedef struct
+{
+    transport_t base;
+    int *fds;
+    transport_spill_t *spills;
+} transport_socket_t;
+
+static void transport_fail(const char *what)
+{
+    perror(what);
+    exit(-1);
+}
+
+/**
+ * @brief Returns room for `len` more bytes at the end of a spill, the caller extends its size.
+ */
+static uint8_t *transport_spill_reserve(transport_spill_t *spill, size_t len)
+{
+    if (spill->offset == spill->size)
+    {
+        spill->size = 0;
+        spill->offset = 0;
+    }
+
+    if (spill->size + len > spill->capacity)
+    {
+        spill->capacity = 2 * (spill->size + len);
+        spill->data = (uint8_t *)realloc(spill->data, spill->capacity);
+        check_null_pointer(spill->data);
+    }
+
+    return spill->data + spill->size;
+}
+
+/**
+ * @brief Moves up to `len` bytes read ahead into `data`, returns how many.
+ */
+static size_t transport_spill_take(transport_spill_t *spill, uint8_t *data, size_t len)
+{
+    size_t chunk = spill->size - spill->offset;
+
+    if (chunk > len)
+        chunk = len;
+
+    if (chunk > 0)
+    {
+        memcpy(data, spill->data + spill->offset, chunk);
+        spill->offset += chunk;
+    }
+
+    return chunk;
+}
+
+static void transport_spills_free(transport_spill_t *spills, uint32_t n)
+{
+    for (uint32_t i = 0; i < n * n; i++)
+    {
+        free(spills[i].data);
+    }
+
+    free(spills);
+}
+
+/* in-process queues: channel from -> to is channels[from * n + to] */
+
+static void transport_queue_send(transport_t *t, uint32_t from, uint32_t to, const uint8_t *data, size_t len)
+{
+    transport_channel_t *channel = &((transport_queue_t *)t)->channels[from * t->n + to];
+
+    transport_message_t *message = (transport_message_t *)malloc(sizeof(transport_message_t) + len);
+    check_null_pointer(message);
+
+    message->next = NULL;
+    message->len = len;
+    memcpy(message->data, data, len);
+
+    pthread_mutex_lock(&channel->lock);
+
+    if (channel->tail)
+        channel->tail->next = message;
+    else
+        channel->head = message;
+
+    channel->tail = message;
+
+    pthread_cond_signal(&channel->ready);
+    pthread_mutex_unlock(&channel->lock);
+}
+
+static uint8_t *transport_queue_recv(transport_t *t, uint32_t to, uint32_t from, size_t *len)
+{
+    transport_channel_t *channel = &((transport_queue_t *)t)->channels[from * t->n + to];
+
+    pthread_mutex_lock(&channel->lock);
+
+    while (channel->head == NULL)
+        pthread_cond_wait(&channel->ready, &channel->lock);
+
+    transport_message_t *message = channel->head;
+
+    channel->head = message->next;
+
+    if (channel->head == NULL)
+        channel->tail = NULL;
+
+    pthread_mutex_unlock(&channel->lock);
+
+    uint8_t *data = (uint8_t *)malloc(message->len ? message->len : 1);
+    check_null_pointer(data);
+
+    memcpy(data, message->data, message->len);
+    *len = message->len;
+
+    free(message);
+
+    return data;
+}
+
+static void transport_queue_free(transport_t *t)
+{
+    transport_queue_t *queue = (transport_queue_t *)t;
+
+    for (uint32_t i = 0; i < t->n * t->n; i++)
+    {
+        transport_message_t *message = queue->channels[i].head;
+
+        while (message)
+        {
+            transport_message_t *next = message->next;
+            free(message);
+            message = next;
+        }
+
+        pthread_mutex_destroy(&queue->channels[i].lock);
+        pthread_cond_destroy(&queue->channels[i].ready);
+    }
+
+    free(queue->channels);
+    free(queue);
+}
+
+static transport_t *transport_queue_new(uint32_t n)
+{
+    transport_queue_t *queue = (transport_queue_t *)calloc(1, sizeof(transport_queue_t));
+    check_null_pointer(queue);
+
+    queue->channels = (transport_channel_t *)calloc(n * n, sizeof(transport_channel_t));
+    check_null_pointer(queue->channels);
+
+    for (uint32_t i = 0; i < n * n; i++)
+    {
+        pthread_mutex_init(&queue->channels[i].lock, NULL);
+        pthread_cond_init(&queue->channels[i].ready, NULL);
+    }
+
+    queue->base.send = transport_queue_send;
+    queue->base.recv = transport_queue_recv;
+    queue->base.destroy = transport_queue_free;
+
+    return &queue->base;
+}
+
+/*
+ * Unix sockets: fds[i * n + j] is the end owned by party i of the pair {i, j}, the bytes that
+ * party j has sent to i but i has read ahead are in spills[j * n + i]
+ */
+
+/**
+ * @brief Reads ahead everything the peers of `to` have sent to it so far, without waiting.
+ */
+static void transport_socket_drain(transport_socket_t *sockets, uint32_t to)
+{
+    uint32_t n = sockets->base.n;
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        if (k == to)
+            continue;
+
+        transport_spill_t *spill = &sockets->spills[k * n + to];
+
+        for (;;)
+        {
+            ssize_t got = recv(sockets->fds[to * n + k], transport_spill_reserve(spill, TRANSPORT_SPILL_CHUNK),
+                               TRANSPORT_SPILL_CHUNK, MSG_DONTWAIT);
+
+            if (got > 0)
+            {
+                spill->size += got;
+                continue;
+            }
+
+            if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+
+            transport_fail("transport read");
+        }
+    }
+}
+
+/**
+ * @brief Writes the whole buffer from `from` to `to`, reading ahead the incoming channels of
+ * `from` whenever the socket is full: its peer may be blocked on a write to `from` as well.
+ */
+static void transport_socket_write(transport_socket_t *sockets, uint32_t from, uint32_t to, const uint8_t *data, size_t len)
+{
+    uint32_t n = sockets->base.n;
+    int fd = sockets->fds[from * n + to];
+    struct pollfd *polls = NULL;
+
+    while (len > 0)
+    {
+        ssize_t written = send(fd, data, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+        if (written > 0)
+        {
+            data += written;
+            len -= written;
+            continue;
+        }
+
+        if (written < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            transport_fail("transport write");
+
+        if (polls == NULL)
+        {
+            polls = (struct pollfd *)malloc(n * sizeof(struct pollfd));
+            check_null_pointer(polls);
+
+            for (uint32_t k = 0; k < n; k++)
+            {
+                polls[k].fd = k == from ? -1 : sockets->fds[from * n + k];
+                polls[k].events = k == to ? POLLIN | POLLOUT : POLLIN;
+            }
+        }
+
+        if (poll(polls, n, -1) < 0 && errno != EINTR)
+            transport_fail("transport poll");
+
+        transport_socket_drain(sockets, from);
+    }
+
+    free(polls);
+}
+
+static void transport_read_all(int fd, transport_spill_t *spill, uint8_t *data, size_t len)
+{
+    size_t taken = transport_spill_take(spill, data, len);
+
+    data += taken;
+    len -= taken;
+
+    while (len > 0)
+    {
+        ssize_t got = read(fd, data, len);
+
+        if (got <= 0)
+            transport_fail("transport read");
+
+        data += got;
+        len -= got;
+    }
+}
+
+static void transport_socket_send(transport_t *t, uint32_t from, uint32_t to, const uint8_t *data, size_t len)
+{
+    transport_socket_t *sockets = (transport_socket_t *)t;
+    uint64_t header = len;
+
+    transport_socket_write(sockets, from, to, (const uint8_t *)&header, sizeof(header));
+    transport_socket_write(sockets, from, to, data, len);
+}
+
+static uint8_t *transport_socket_recv(transport_t *t, uint32_t to, uint32_t from, size_t *len)
+{
+    int fd = ((transport_socket_t *)t)->fds[to * t->n + from];
+    transport_spill_t *spill = &((transport_socket_t *)t)->spills[from * t->n + to];
+    uint64_t header;
+
+    transport_read_all(fd, spill, (uint8_t *)&header, sizeof(header));
+
+    uint8_t *data = (uint8_t *)malloc(header ? header : 1);
+    check_null_pointer(data);
+
+    transport_read_all(fd, spill, data, header);
+    *len = header;
+
+    return data;
+}
+
+static void transport_socket_free(transport_t *t)
+{
+    transport_socket_t *sockets = (transport_socket_t *)t;
+
+    for (uint32_t i = 0; i < t->n * t->n; i++)
+    {
+        if (sockets->fds[i] >= 0)
+            close(sockets->fds[i]);
+    }
+
+    transport_spills_free(sockets->spills, t->n);
+
+    free(sockets->fds);
+    free(sockets);
+}
+
+static transport_t *transport_socket_new(uint32_t n)
+{
+    transport_socket_t *sockets = (transport_socket_t *)calloc(1, sizeof(transport_socket_t));
+    check_null_pointer(sockets);
+
+    sockets->fds = (int *)malloc(n * n * sizeof(int));
+    check_null_pointer(sockets->fds);
+
+    sockets->spills = (transport_spill_t *)calloc(n * n, sizeof(transport_spill_t));
+    check_null_pointer(sockets->spills);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        sockets->fds[i * n + i] = -1;
+
+        for (uint32_t j = i + 1; j < n; j++)
+        {
+            int pair[2];
+            int size = TRANSPORT_SOCKET_BUFFER;
+
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+                transport_fail("transport socketpair");
+
+            // best effort: the kernel may cap the buffer
+            setsockopt(pair[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+            setsockopt(pair[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+
+            sockets->fds[i * n + j] = pair[0];
+            sockets->fds[j * n + i] = pair[1];
+        }
+    }
+
+    sockets->base.send = transport_socket_send;
+    sockets->base.recv = transport_socket_recv;
+    sockets->base.destroy = transport_socket_free;
+
+    return &sockets->base;
+}
+
+/*
+ * shared memory: ring from -> to is rings[from * n + to]. head and tail count the bytes ever
+ * written and read; only the producer moves head and only the consumer moves tail. The
+ * sequence words are the futex addresses, the waiting flags let the other side skip the
+ * wake syscall when nobody sleeps. The bytes party i has read ahead from rings[j * n + i] are
+ * in spills[j * n + i], which lives in the memory of party i, not in the shared mapping.
+ */
+
+typedef struct
+{
+    _Alignas(64) atomic_uint_fast64_t head;
+    atomic_uint data_seq;
+    atomic_uint consumer_waiting;
+
+    _Alignas(64) atomic_uint_fast64_t tail;
+    atomic_uint space_seq;
+    atomic_uint producer_waiting;
+
+    _Alignas(64) uint8_t buffer[TRANSPORT_SHM_RING_SIZE];
+} transport_ring_t;
+
+typedef struct
+{
+    transport_t base;
+    transport_ring_t *rings;
+    size_t mapping_size;
+    transport_spill_t *spills;
+} transport_shm_t;
+
+static void transport_futex_wait(atomic_uint *word, uint32_t expected, const struct timespec *timeout)
+{
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static void transport_futex_wake(atomic_uint *word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/**
+ * @brief Waits until `ready` holds, spinning briefly before sleeping on the futex `seq`.
+ */
+#define transport_ring_wait(RING, READY, SEQ, WAITING)                     \
+    {                                                                      \
+        for (uint32_t spin = 0; !(READY); spin++)                          \
+        {                                                                  \
+            if (spin < TRANSPORT_SHM_SPIN)                                 \
+                continue;                                                  \
+                                                                           \
+            uint32_t seq = atomic_load(&(RING)->SEQ);                      \
+            atomic_store(&(RING)->WAITING, 1);                             \
+                                                                           \
+            if (!(READY))                                                  \
+                transport_futex_wait(&(RING)->SEQ, seq, NULL);             \
+                                                                           \
+            atomic_store(&(RING)->WAITING, 0);                             \
+        }                                                                  \
+    }
+
+/**
+ * @brief Moves the tail of a ring and wakes its producer if it sleeps.
+ */
+static void transport_ring_consume(transport_ring_t *ring, uint64_t tail)
+{
+    atomic_store(&ring->tail, tail);
+    atomic_fetch_add(&ring->space_seq, 1);
+
+    if (atomic_load(&ring->producer_waiting))
+        transport_futex_wake(&ring->space_seq);
+}
+
+/**
+ * @brief Reads ahead everything the peers of `to` have written to it so far, without waiting.
+ *
+ * @return 1 if any byte has been read.
+ */
+static uint8_t transport_shm_drain(transport_shm_t *shm, uint32_t to)
+{
+    uint32_t n = shm->base.n;
+    uint8_t drained = 0;
+
+    for (uint32_t k = 0; k < n; k++)
+    {
+        if (k == to)
+            continue;
+
+        transport_ring_t *ring = &shm->rings[k * n + to];
+        uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        uint64_t available = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+
+        if (available == 0)
+            continue;
+
+        transport_spill_t *spill = &shm->spills[k * n + to];
+        uint8_t *dst = transport_spill_reserve(spill, available);
+        uint64_t offset = tail & (TRANSPORT_SHM_RING_SIZE - 1);
+        uint64_t first = available < TRANSPORT_SHM_RING_SIZE - offset ? available : TRANSPORT_SHM_RING_SIZE - offset;
+
+        memcpy(dst, ring->buffer + offset, first);
+        memcpy(dst + first, ring->buffer, available - first);
+        spill->size += available;
+
+        transport_ring_consume(ring, tail + available);
+        drained = 1;
+    }
+
+    return drained;
+}
+
+/**
+ * @brief Writes the whole buffer into the ring from `from`, reading ahead the incoming rings of
+ * `from` while it is full: its consumer may be blocked on a write to `from` as well.
+ */
+static void transport_ring_write(transport_shm_t *shm, uint32_t from, transport_ring_t *ring, const uint8_t *data, size_t len)
+{
+    const struct timespec timeout = {0, TRANSPORT_SHM_DRAIN_NS};
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    while (len > 0)
+    {
+        for (uint32_t spin = 0; head - atomic_load_explicit(&ring->tail, memory_order_acquire) == TRANSPORT_SHM_RING_SIZE; spin++)
+        {
+            if (transport_shm_drain(shm, from) || spin < TRANSPORT_SHM_SPIN)
+                continue;
+
+            // nothing wakes this side when data comes in, hence the timeout
+            uint32_t seq = atomic_load(&ring->space_seq);
+            atomic_store(&ring->producer_waiting, 1);
+
+            if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == TRANSPORT_SHM_RING_SIZE)
+                transport_futex_wait(&ring->space_seq, seq, &timeout);
+
+            atomic_store(&ring->producer_waiting, 0);
+        }
+
+        uint64_t free_space = TRANSPORT_SHM_RING_SIZE - (head - atomic_load_explicit(&ring->tail, memory_order_acquire));
+        uint64_t offset = head & (TRANSPORT_SHM_RING_SIZE - 1);
+        uint64_t chunk = len;
+
+        if (chunk > free_space)
+            chunk = free_space;
+
+        if (chunk > TRANSPORT_SHM_RING_SIZE - offset)
+            chunk = TRANSPORT_SHM_RING_SIZE - offset;
+
+        memcpy(ring->buffer + offset, data, chunk);
+
+        head += chunk;
+        data += chunk;
+        len -= chunk;
+
+        atomic_store(&ring->head, head);
+        atomic_fetch_add(&ring->data_seq, 1);
+
+        if (atomic_load(&ring->consumer_waiting))
+            transport_futex_wake(&ring->data_seq);
+    }
+}
+
+static void transport_ring_read(transport_ring_t *ring, transport_spill_t *spill, uint8_t *data, size_t len)
+{
+    size_t taken = transport_spill_take(spill, data, len);
+
+    data += taken;
+    len -= taken;
+
+    uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    while (len > 0)
+    {
+        transport_ring_wait(ring, atomic_load_explicit(&ring->head, memory_order_acquire) != tail,
+                            data_seq, consumer_waiting);
+
+        uint64_t available = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+        uint64_t offset = tail & (TRANSPORT_SHM_RING_SIZE - 1);
+        uint64_t chunk = len;
+
+        if (chunk > available)
+            chunk = available;
+
+        if (chunk > TRANSPORT_SHM_RING_SIZE - offset)
+            chunk = TRANSPORT_SHM_RING_SIZE - offset;
+
+        memcpy(data, ring->buffer + offset, chunk);
+
+        tail += chunk;
+        data += chunk;
+        len -= chunk;
+
+        transport_ring_consume(ring, tail);
+    }
+}
+
+static void transport_shm_send(transport_t *t, uint32_t from, uint32_t to, const uint8_t *data, size_t len)
+{
+    transport_shm_t *shm = (transport_shm_t *)t;
+    transport_ring_t *ring = &shm->rings[from * t->n + to];
+    uint64_t header = len;
+
+    transport_ring_write(shm, from, ring, (const uint8_t *)&header, sizeof(header));
+    transport_ring_write(shm, from, ring, data, len);
+}
+
+static uint8_t *transport_shm_recv(transport_t *t, uint32_t to, uint32_t from, size_t *len)
+{
+    transport_ring_t *ring = &((transport_shm_t *)t)->rings[from * t->n + to];
+    transport_spill_t *spill = &((transport_shm_t *)t)->spills[from * t->n + to];
+    uint64_t header;
+
+    transport_ring_read(ring, spill, (uint8_t *)&header, sizeof(header));
+
+    uint8_t *data = (uint8_t *)malloc(header ? header : 1);
+    check_null_pointer(data);
+
+    transport_ring_read(ring, spill, data, header);
+    *len = header;
+
+    return data;
+}
+
+static void transport_shm_free(transport_t *t)
+{
+    transport_shm_t *shm = (transport_shm_t *)t;
+
+    munmap(shm->rings, shm->mapping_size);
+    transport_spills_free(shm->spills, t->n);
+    free(shm);
+}
+
+static transport_t *transport_shm_new(uint32_t n)
+{
+    transport_shm_t *shm = (transport_shm_t *)calloc(1, sizeof(transport_shm_t));
+    check_null_pointer(shm);
+
+    // the pages of a ring are only touched once the pair talks
+    shm->mapping_size = (size_t)n * n * sizeof(transport_ring_t);
+    shm->rings = (transport_ring_t *)mmap(NULL, shm->mapping_size, PROT_READ | PROT_WRITE,
+                                          MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (shm->rings == MAP_FAILED)
+        transport_fail("transport mmap");
+
+    shm->spills = (transport_spill_t *)calloc(n * n, sizeof(transport_spill_t));
+    check_null_pointer(shm->spills);
+
+    shm->base.send = transport_shm_send;
+    shm->base.recv = transport_shm_recv;
+    shm->base.destroy = transport_shm_free;
+
+    return &shm->base;
+}
+
+transport_t *transport_new(transport_kind_t kind, uint32_t n)
+{
+    transport_t *t;
+
+    if (kind == TRANSPORT_SOCKET)
+        t = transport_socket_new(n);
+    else if (kind == TRANSPORT_SHM)
+        t = transport_shm_new(n);
+    else
+        t = transport_queue_new(n);
+
+    t->n = n;
+    t->kind = kind;
+
+    atomic_init(&t->bytes, 0);
+    atomic_init(&t->messages, 0);
+
+    return t;
+}
+
+void transport_send(transport_t *t, uint32_t from, uint32_t to, const uint8_t *data, size_t len)
+{
+    atomic_fetch_add_explicit(&t->bytes, len, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->messages, 1, memory_order_relaxed);
+
+    t->send(t, from, to, data, len);
+}
+
+uint8_t *transport_recv(transport_t *t, uint32_t to, uint32_t from, size_t *len)
+{
+    return t->recv(t, to, from, len);
+}
+
+const char *transport_name(transport_kind_t kind)
+{
+    switch (kind)
+    {
+    case TRANSPORT_SOCKET:
+        return "socket";
+    case TRANSPORT_SHM:
+        return "shm";
+    default:
+        return "queue";
+    }
+}
+
+void transport_reset_counters(transport_t *t)
+{
+    atomic_store(&t->bytes, 0);
+    atomic_store(&t->messages, 0);
+}
+
+void transport_free(transport_t *t)
+{
+    t->destroy(t);
+}
@@ -9,25 +9,91 @@ void check_null_pointer(void *ptr)
     }
 }
 
+static uint32_t sieve_primes[PRIME_SIEVE_BOUND / 2];
+static uint32_t sieve_primes_count;
+static pthread_once_t sieve_primes_once = PTHREAD_ONCE_INIT;
+
+static void sieve_primes_init()
+{
+    uint8_t *composite = (uint8_t *)calloc(PRIME_SIEVE_BOUND, sizeof(uint8_t));
+    check_null_pointer(composite);
+
+    // 2 is skipped: candidates are odd by construction
+    for (uint32_t i = 3; i < PRIME_SIEVE_BOUND; i += 2)
+    {
+        if (composite[i])
+            continue;
+
+        sieve_primes[sieve_primes_count++] = i;
+
+        for (uint32_t j = i * i; j < PRIME_SIEVE_BOUND; j += 2 * i)
+            composite[j] = 1;
+    }
+
+    free(composite);
+}
+
 void mpz_set_lbit_prime(mpz_t dst, gmp_randstate_t prng, __uint32_t l)
 {
-    mpz_t remain, modulo;
+    uint8_t composite[PRIME_SIEVE_WINDOW];
 
-    mpz_init_set_ui(remain, 3);
-    mpz_init_set_ui(modulo, 4);
+    mpz_t base;
+    mpz_init(base);
 
-    do
-        mpz_urandomb(dst, prng, l);
-    while (
-        mpz_sizeinbase(dst, 2) < l
-        // we want a number with k bits
-        || mpz_probab_prime_p(dst, PRIME_ITERATIONS) == 0
-        // we want a number that is prime
-        || mpz_congruent_p(dst, remain, modulo) == 0
-        // we want that the prime number is congruent to 3 mod 4
-    );
-
-    mpz_clears(remain, modulo, NULL);
+    pthread_once(&sieve_primes_once, sieve_primes_init);
+
+    for (;;)
+    {
+        // the top bit gives exactly l bits, the two low bits give 3 mod 4
+        mpz_urandomb(base, prng, l);
+        mpz_setbit(base, l - 1);
+        mpz_setbit(base, 1);
+        mpz_setbit(base, 0);
+
+        // candidate i is base + 4 * i: cross out those with a small factor
+        memset(composite, 0, sizeof(composite));
+
+        for (uint32_t i = 0; i < sieve_primes_count; i++)
+        {
+            uint32_t p = sieve_primes[i];
+            uint32_t r = mpz_fdiv_ui(base, p);
+            uint32_t inverse_4 = (p % 4 == 3) ? (p + 1) / 4 : (3 * p + 1) / 4;
+
+            for (uint64_t j = (uint64_t)((p - r) % p) * inverse_4 % p; j < PRIME_SIEVE_WINDOW; j += p)
+                composite[j] = 1;
+        }
+
+        for (uint32_t i = 0; i < PRIME_SIEVE_WINDOW; i++)
+        {
+            if (composite[i])
+                continue;
+
+            mpz_add_ui(dst, base, 4 * i);
+
+            if (mpz_sizeinbase(dst, 2) > l)
+                break;
+
+            // BPSW on the survivors only
+            if (mpz_probab_prime_p(dst, PRIME_ITERATIONS) != 0)
+            {
+                mpz_clear(base);
+                return;
+            }
+        }
+    }
+}
+
+void gmp_randinit_derived(gmp_randstate_t dst, gmp_randstate_t parent)
+{
+    mpz_t seed;
+    mpz_init(seed);
+
+    mpz_urandomb(seed, parent, PRNG_DERIVED_SEED_BITS);
+
+    random_init(dst, random_backend(parent));
+    gmp_randseed(dst, seed);
+
+    mpz_clear(seed);
 }
 
 void mpz_set_random_n_coprime(mpz_t dst, mpz_t n, gmp_randstate_t prng)
@@ -51,6 +117,11 @@ void mpz_set_random_n_coprime(mpz_t dst, mpz_t n, gmp_randstate_t prng)
 
 void mpz_double_pow(mpz_t dst, uint32_t T, uint32_t j, mpz_t N)
 {
+#ifdef USE_FIXED_LIMB
+    if (fixed_limb_double_pow(dst, T + 1 - j, N))
+        return;
+#endif
+
     mpz_t exponent;
 
     mpz_init(exponent);
@@ -61,6 +132,34 @@ void mpz_double_pow(mpz_t dst, uint32_t T, uint32_t j, mpz_t N)
     mpz_clear(exponent);
 }
 
+void mpz_double_pow_batch(mpz_t *values, uint32_t count, uint32_t T, uint32_t j, mpz_t N)
+{
+    mpz_square_batch(values, count, T + 1 - j, N);
+}
+
+void mpz_square_batch(mpz_t *values, uint32_t count, uint32_t squarings, mpz_t N)
+{
+    if (count >= SIMD_MONT_MIN_BATCH && simd_mont_square_batch(values, count, squarings, N))
+        return;
+
+#ifdef USE_FIXED_LIMB
+    if (fixed_limb_double_pow_batch(values, count, squarings, N))
+        return;
+#endif
+
+    mpz_t exponent;
+
+    mpz_init(exponent);
+    mpz_setbit(exponent, squarings);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        mpz_powm(values[i], values[i], exponent, N);
+    }
+
+    mpz_clear(exponent);
+}
+
 uint8_t *compute_hash_digest(const char *m, uint32_t hash_len)
 {
     if (!m || hash_len == 0)
@@ -88,21 +187,25 @@ uint8_t *compute_hash_digest(const char *m, uint32_t hash_len)
 
 void mpz_mmul_pow_array(mpz_t dst, const mpz_t base, const uint8_t *c, const mpz_t *key, const uint32_t l, const mpz_t N)
 {
-    mpz_t *tmp = (mpz_t *)malloc(l * sizeof(mpz_t));
-    check_null_pointer(tmp);
+#ifdef USE_FIXED_LIMB
+    if (fixed_limb_mmul_pow_array(dst, base, c, key, l, N))
+        return;
+#endif
 
     mpz_set(dst, base);
 
-    for (uint8_t i = 0; i < l; i++)
+    // the exponents are bits: multiply in the selected keys, reducing as we go so that
+    // the product never grows past two moduli
+    for (uint32_t i = 0; i < l; i++)
     {
-        mpz_init(tmp[i]);
-        mpz_powm_ui(tmp[i], key[i], c[i], N);
-        mpz_mul(dst, dst, tmp[i]);
-        mpz_clear(tmp[i]);
+        if (c[i] == 0)
+            continue;
+
+        mpz_mul(dst, dst, key[i]);
+        mpz_mod(dst, dst, N);
     }
 
     mpz_mod(dst, dst, N);
-    free(tmp);
 }
 
 void mpz_mmul_array(mpz_t dst, mpz_t *array, uint32_t size, mpz_t N)
@@ -125,88 +228,223 @@ void mpz_madd_array(mpz_t dst, mpz_t *array, uint32_t size, mpz_t N)
     mpz_mod(dst, dst, N);
 }
 
-void shamir_ss(mpz_point_t *out, uint32_t size, mpz_t secret, uint32_t k, gmp_randstate_t prng, mpz_t modulo)
+uint8_t mpz_batch_invert(mpz_t *dst, mpz_t *src, uint32_t size, mpz_t N)
 {
-    mpz_t *polynomial = polynomial = (mpz_t *)malloc(k * sizeof(mpz_t));
-    check_null_pointer(polynomial);
+    mpz_t inverse, tmp;
+    mpz_inits(inverse, tmp, NULL);
 
-    mpz_init_set(polynomial[0], secret);
+    // dst[i] temporarily holds the prefix product src[0] * ... * src[i]
+    mpz_set(dst[0], src[0]);
 
-    for (uint32_t i = 1; i < k; i++)
+    for (uint32_t i = 1; i < size; i++)
     {
-        mpz_init(polynomial[i]);
+        mpz_mul(dst[i], dst[i - 1], src[i]);
+        mpz_mod(dst[i], dst[i], N);
+    }
 
-        do
-            mpz_urandomm(polynomial[i], prng, modulo);
-        while (mpz_cmp_ui(polynomial[i], 0) == 0);
+    if (mpz_invert(inverse, dst[size - 1], N) == 0)
+    {
+        mpz_clears(inverse, tmp, NULL);
+        return 0;
     }
 
-    for (uint32_t i = 0; i < size; i++)
+    // walk back peeling one factor at a time off the inverse of the prefix
+    for (uint32_t i = size - 1; i > 0; i--)
     {
-        mpz_init_set_ui(out[i].x, i + 1);
-        mpz_init_set(out[i].y, polynomial[k - 1]);
+        mpz_mul(tmp, inverse, src[i]);
+        mpz_mod(tmp, tmp, N);
+
+        mpz_mul(dst[i], inverse, dst[i - 1]);
+        mpz_mod(dst[i], dst[i], N);
+
+        mpz_swap(inverse, tmp);
+    }
+
+    mpz_set(dst[0], inverse);
+
+    mpz_clears(inverse, tmp, NULL);
+
+    return 1;
+}
+
+/**
+ * @brief Horner's method at `x`, the result is congruent to the value of the polynomial but not reduced.
+ *
+ * At an abscissa that fits a limb the value only grows by the bits of `x` at every step and is
+ * never reduced; otherwise it is reduced when it outgrows the modulus by a limb.
+ */
+static void polynomial_eval_lazy(mpz_t y, mpz_t *polynomial, uint32_t k, const mpz_t x, mpz_t modulo)
+{
+    const size_t limit = mpz_size(modulo) + 1;
+
+    mpz_set(y, polynomial[k - 1]);
+
+    if (mpz_fits_ulong_p(x))
+    {
+        unsigned long x_ui = mpz_get_ui(x);
 
-        // Horner's method
         for (int32_t j = k - 2; j >= 0; j--)
         {
-            mpz_mul(out[i].y, out[i].y, out[i].x);
-            mpz_add(out[i].y, out[i].y, polynomial[j]);
-            mpz_mod(out[i].y, out[i].y, modulo);
+            mpz_mul_ui(y, y, x_ui);
+            mpz_add(y, y, polynomial[j]);
         }
+
+        return;
     }
 
-    for (uint32_t i = 0; i < k; i++)
+    for (int32_t j = k - 2; j >= 0; j--)
     {
-        mpz_clear(polynomial[i]);
+        mpz_mul(y, y, x);
+        mpz_add(y, y, polynomial[j]);
+
+        if (mpz_size(y) > limit)
+            mpz_mod(y, y, modulo);
     }
-    free(polynomial);
 }
 
-void lagrange_interpolation(mpz_t result, mpz_point_t *shares, mpz_t point, uint32_t size, mpz_t modulo)
+void polynomial_eval_points(mpz_point_t *out, uint32_t size, mpz_t *polynomial, uint32_t k, mpz_t modulo)
 {
-    mpz_set_ui(result, 0);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        polynomial_eval_lazy(out[i].y, polynomial, k, out[i].x, modulo);
+        mpz_mod(out[i].y, out[i].y, modulo);
+    }
+}
 
+/**
+ * @brief Draws the `k - 1` random non zero coefficients of a sharing polynomial.
+ */
+static void polynomial_random_coefficients(mpz_t *polynomial, uint32_t k, gmp_randstate_t prng, mpz_t modulo)
+{
+    mpz_urandomm_array(polynomial + 1, k - 1, prng, modulo);
+
+    for (uint32_t i = 1; i < k; i++)
+    {
+        while (mpz_cmp_ui(polynomial[i], 0) == 0)
+            mpz_urandomm(polynomial[i], prng, modulo);
+    }
+}
+
+/**
+ * @brief Fills `powers[i * k + j]` with the j-th power of the abscissa of `points[i]`, for j < k.
+ *
+ * @return 0 if a power does not fit a limb, the table is then not usable.
+ */
+static uint8_t polynomial_power_table(unsigned long *powers, mpz_point_t *points, uint32_t size, uint32_t k)
+{
     for (uint32_t i = 0; i < size; i++)
     {
-        mpz_t term;
-        mpz_init_set(term, shares[i].y);
+        if (!mpz_fits_ulong_p(points[i].x))
+            return 0;
 
-        for (uint32_t j = 0; j < size; j++)
+        unsigned long x = mpz_get_ui(points[i].x);
+
+        powers[i * k] = 1;
+
+        for (uint32_t j = 1; j < k; j++)
         {
-            if (j == i)
-                continue;
+            if (x != 0 && powers[i * k + j - 1] > ULONG_MAX / x)
+                return 0;
 
-            mpz_t num, denom;
-            mpz_inits(num, denom, NULL);
+            powers[i * k + j] = powers[i * k + j - 1] * x;
+        }
+    }
 
-            mpz_set(num, point);
-            mpz_sub(num, num, shares[j].x);
-            mpz_mod(num, num, modulo);
+    return 1;
+}
 
-            mpz_set(denom, shares[i].x);
-            mpz_sub(denom, denom, shares[j].x);
+/**
+ * @brief One player's resharing of `polynomial[0]`: draws the rest of its polynomial and adds the
+ * share of player i, unreduced, to `sums[i]`.
+ *
+ * The sums are what the players hold once they have added up the shares received from every
+ * resharing player; they are reduced by the caller after the last one. With a table of
+ * `polynomial_power_table` every share is a row of independent fused multiply-adds, otherwise
+ * it is evaluated with Horner's method.
+ */
+static void shamir_ss_accumulate(mpz_t *sums, mpz_point_t *points, const unsigned long *powers, uint32_t size, mpz_t *polynomial, uint32_t k, mpz_t evaluation, gmp_randstate_t prng, mpz_t modulo)
+{
+    polynomial_random_coefficients(polynomial, k, prng, modulo);
 
-            mpz_mod(denom, denom, modulo);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (powers)
+        {
+            mpz_set(evaluation, polynomial[0]);
 
-            if (mpz_invert(denom, denom, modulo) == 0)
+            for (uint32_t j = 1; j < k; j++)
             {
-                gmp_printf("Error: Inverse does not exist for denom %Zd mod %Zd\n", denom, modulo);
-                exit(0);
+                mpz_addmul_ui(evaluation, polynomial[j], powers[i * k + j]);
             }
+        }
+        else
+            polynomial_eval_lazy(evaluation, polynomial, k, points[i].x, modulo);
 
-            mpz_mul(term, term, num);
-            mpz_mul(term, term, denom);
-            mpz_mod(term, term, modulo);
+        mpz_add(sums[i], sums[i], evaluation);
+    }
+}
 
-            mpz_clear(num);
-            mpz_clear(denom);
-        }
+void shamir_ss(mpz_point_t *out, uint32_t size, mpz_t secret, uint32_t k, gmp_randstate_t prng, mpz_t modulo)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_init_set_ui(out[i].x, i + 1);
+        mpz_init(out[i].y);
+    }
 
-        mpz_add(result, result, term);
-        mpz_mod(result, result, modulo);
+    shamir_ss_at(out, size, secret, k, prng, modulo);
+}
 
-        mpz_clear(term);
+void shamir_ss_at(mpz_point_t *out, uint32_t size, mpz_t secret, uint32_t k, gmp_randstate_t prng, mpz_t modulo)
+{
+    mpz_t *polynomial = (mpz_t *)malloc(k * sizeof(mpz_t));
+    check_null_pointer(polynomial);
+
+    mpz_init_set(polynomial[0], secret);
+
+    for (uint32_t i = 1; i < k; i++)
+    {
+        mpz_init(polynomial[i]);
     }
+
+    polynomial_random_coefficients(polynomial, k, prng, modulo);
+
+    polynomial_eval_points(out, size, polynomial, k, modulo);
+
+    for (uint32_t i = 0; i < k; i++)
+    {
+        mpz_clear(polynomial[i]);
+    }
+    free(polynomial);
+}
+
+void lagrange_interpolation(mpz_t result, mpz_point_t *shares, mpz_t point, uint32_t size, mpz_t modulo)
+{
+    mpz_t *lambda = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(lambda);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_init(lambda[i]);
+    }
+
+    lagrange_coefficients_at(lambda, shares, point, size, modulo);
+
+    mpz_mul(result, lambda[0], shares[0].y);
+
+    for (uint32_t i = 1; i < size; i++)
+    {
+        mpz_addmul(result, lambda[i], shares[i].y);
+    }
+
+    mpz_mod(result, result, modulo);
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_clear(lambda[i]);
+    }
+
+    free(lambda);
 }
 
 void mpz_clear_point(mpz_point_t point)
@@ -217,96 +455,452 @@ void mpz_clear_point(mpz_point_t point)
 
 void joint_shamir_ss(mpz_point_t *dst, mpz_t *secrets, uint32_t treshold, uint32_t size, gmp_randstate_t prng, mpz_t modulo)
 {
-    mpz_point_t **shares = (mpz_point_t **)malloc(size * sizeof(mpz_point_t *));
-    check_null_pointer(shares);
+    for (uint32_t k = 0; k < size; k++)
+    {
+        mpz_init_set_ui(dst[k].x, k + 1);
+        mpz_init(dst[k].y);
+    }
 
-    for (uint32_t j = 0; j < size; j++)
+    joint_shamir_ss_at(dst, secrets, treshold, size, prng, modulo);
+}
+
+void joint_shamir_ss_at(mpz_point_t *dst, mpz_t *secrets, uint32_t treshold, uint32_t size, gmp_randstate_t prng, mpz_t modulo)
+{
+    mpz_t *polynomial = (mpz_t *)malloc(treshold * sizeof(mpz_t));
+    check_null_pointer(polynomial);
+
+    for (uint32_t i = 0; i < treshold; i++)
     {
-        shares[j] = (mpz_point_t *)malloc(size * sizeof(mpz_point_t));
-        check_null_pointer(shares[j]);
+        mpz_init(polynomial[i]);
+    }
+
+    mpz_t evaluation;
+    mpz_init(evaluation);
+
+    mpz_t *sums = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(sums);
+
+    unsigned long *powers = (unsigned long *)malloc(size * treshold * sizeof(unsigned long));
+    check_null_pointer(powers);
 
-        shamir_ss(shares[j], size, secrets[j], treshold, prng, modulo);
+    for (uint32_t k = 0; k < size; k++)
+    {
+        mpz_init(sums[k]);
     }
 
+    uint8_t table = polynomial_power_table(powers, dst, size, treshold);
+
+    // every player shares its own secret and every player adds up the shares it receives:
+    // the sum is never computed in one place
     for (uint32_t i = 0; i < size; i++)
     {
-        mpz_init_set_ui(dst[i].x, i + 1);
-        mpz_init_set(dst[i].y, shares[0][i].y);
+        mpz_set(polynomial[0], secrets[i]);
 
-        for (uint32_t j = 1; j < size; j++)
+        shamir_ss_accumulate(sums, dst, table ? powers : NULL, size, polynomial, treshold, evaluation, prng, modulo);
+    }
+
+    for (uint32_t k = 0; k < size; k++)
+    {
+        mpz_mod(dst[k].y, sums[k], modulo);
+        mpz_clear(sums[k]);
+    }
+
+    for (uint32_t i = 0; i < treshold; i++)
+    {
+        mpz_clear(polynomial[i]);
+    }
+
+    free(polynomial);
+    free(sums);
+    free(powers);
+
+    mpz_clear(evaluation);
+}
+
+void lagrange_coefficients_at(mpz_t *dst, mpz_point_t *shares, mpz_t point, uint32_t size, mpz_t modulo)
+{
+    const size_t limit = mpz_size(modulo) + 1;
+
+    mpz_t *denominators = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(denominators);
+
+    mpz_t diff, numerator;
+    mpz_inits(diff, numerator, NULL);
+
+    // at an abscissa of the shares the polynomial is that share
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (mpz_congruent_p(point, shares[i].x, modulo))
         {
-            mpz_add(dst[i].y, dst[i].y, shares[j][i].y);
+            for (uint32_t j = 0; j < size; j++)
+            {
+                mpz_set_ui(dst[j], i == j);
+            }
+
+            mpz_clears(diff, numerator, NULL);
+            free(denominators);
+
+            return;
         }
+    }
+
+    // the abscissas are usually 1, ..., n: their differences are machine words
+    uint8_t small = 1;
 
-        mpz_mod(dst[i].y, dst[i].y, modulo);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        small &= mpz_cmpabs_ui(shares[i].x, LONG_MAX / 2) < 0;
     }
 
+    // lambda_i = prod_j (point - x_j) / ((point - x_i) * prod_{j != i} (x_i - x_j)): the
+    // differences of the abscissas are small, their products are only reduced when they
+    // outgrow the modulus, and all the denominators are inverted together
+    mpz_set_ui(numerator, 1);
+
     for (uint32_t i = 0; i < size; i++)
     {
+        mpz_init(denominators[i]);
+        mpz_sub(denominators[i], point, shares[i].x);
+        mpz_mod(denominators[i], denominators[i], modulo);
+
+        mpz_mul(numerator, numerator, denominators[i]);
+        mpz_mod(numerator, numerator, modulo);
+
+        long word = 1;
+
         for (uint32_t j = 0; j < size; j++)
         {
-            mpz_clear_point(shares[i][j]);
+            if (j == i)
+                continue;
+
+            if (small)
+            {
+                // several differences are multiplied in a machine word before touching the mpz
+                long factor = mpz_get_si(shares[i].x) - mpz_get_si(shares[j].x), next;
+
+                if (!__builtin_mul_overflow(word, factor, &next))
+                {
+                    word = next;
+                    continue;
+                }
+
+                mpz_mul_si(denominators[i], denominators[i], word);
+                word = factor;
+            }
+            else
+            {
+                mpz_sub(diff, shares[i].x, shares[j].x);
+                mpz_mul(denominators[i], denominators[i], diff);
+            }
+
+            if (mpz_size(denominators[i]) > limit)
+                mpz_mod(denominators[i], denominators[i], modulo);
         }
 
-        free(shares[i]);
+        mpz_mul_si(denominators[i], denominators[i], word);
+
+        mpz_mod(denominators[i], denominators[i], modulo);
     }
 
-    free(shares);
+    if (mpz_batch_invert(dst, denominators, size, modulo) == 0)
+    {
+        gmp_printf("Error: Inverse does not exist for some denom mod %Zd\n", modulo);
+        exit(0);
+    }
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_mul(dst[i], dst[i], numerator);
+        mpz_mod(dst[i], dst[i], modulo);
+
+        mpz_clear(denominators[i]);
+    }
+
+    free(denominators);
+
+    mpz_clears(diff, numerator, NULL);
 }
 
-void mult_shamir_ss(mpz_point_t *dst, mpz_point_t *shares_a, mpz_point_t *shares_b, uint32_t size, uint32_t treshold, gmp_randstate_t prng, mpz_t modulo)
+void lagrange_basis_coefficients(mpz_t *dst, mpz_point_t *points, uint32_t size, mpz_t modulo)
 {
+    mpz_t *weights = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(weights);
 
-    mpz_t point;
-    mpz_init_set_ui(point, 0);
+    mpz_t *denominators = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(denominators);
 
-    mpz_point_t **shares = (mpz_point_t **)malloc(size * sizeof(mpz_point_t *));
-    check_null_pointer(shares);
+    // prod_m (x - x_m), with one coefficient more than the basis polynomials
+    mpz_t *product = (mpz_t *)malloc((size + 1) * sizeof(mpz_t));
+    check_null_pointer(product);
 
-    for (uint32_t i = 0; i < size; i++)
+    mpz_t diff, carry;
+    mpz_inits(diff, carry, NULL);
+
+    for (uint32_t k = 0; k <= size; k++)
+    {
+        mpz_init_set_ui(product[k], k == 0);
+    }
+
+    for (uint32_t m = 0; m < size; m++)
+    {
+        for (int32_t k = m + 1; k >= 0; k--)
+        {
+            mpz_mul(product[k], product[k], points[m].x);
+            mpz_neg(product[k], product[k]);
+
+            if (k > 0)
+                mpz_add(product[k], product[k], product[k - 1]);
+
+            mpz_mod(product[k], product[k], modulo);
+        }
+    }
+
+    // w_j = 1 / prod_{m != j} (x_j - x_m), all inverted together
+    for (uint32_t j = 0; j < size; j++)
+    {
+        mpz_inits(weights[j], denominators[j], NULL);
+        mpz_set_ui(denominators[j], 1);
+
+        for (uint32_t m = 0; m < size; m++)
+        {
+            if (m == j)
+                continue;
+
+            mpz_sub(diff, points[j].x, points[m].x);
+            mpz_mul(denominators[j], denominators[j], diff);
+            mpz_mod(denominators[j], denominators[j], modulo);
+        }
+    }
+
+    if (mpz_batch_invert(weights, denominators, size, modulo) == 0)
     {
-        mpz_mul(dst[i].y, shares_a[i].y, shares_b[i].y);
-        mpz_mod(dst[i].y, dst[i].y, modulo);
+        gmp_printf("Error: Inverse does not exist for some denom mod %Zd\n", modulo);
+        exit(0);
+    }
 
-        shares[i] = (mpz_point_t *)malloc(size * sizeof(mpz_point_t));
-        check_null_pointer(shares[i]);
+    // L_j = w_j * prod_m (x - x_m) / (x - x_j), by synthetic division from the top coefficient
+    for (uint32_t j = 0; j < size; j++)
+    {
+        mpz_set_ui(carry, 0);
+
+        for (int32_t k = size - 1; k >= 0; k--)
+        {
+            mpz_mul(carry, carry, points[j].x);
+            mpz_add(carry, carry, product[k + 1]);
+            mpz_mod(carry, carry, modulo);
 
-        shamir_ss(shares[i], size, dst[i].y, treshold, prng, modulo);
+            mpz_mul(dst[j * size + k], carry, weights[j]);
+            mpz_mod(dst[j * size + k], dst[j * size + k], modulo);
+        }
+    }
+
+    for (uint32_t j = 0; j < size; j++)
+    {
+        mpz_clears(weights[j], denominators[j], NULL);
     }
 
-    mpz_point_t *tmp = (mpz_point_t *)malloc(size * sizeof(mpz_point_t));
-    check_null_pointer(tmp);
+    for (uint32_t k = 0; k <= size; k++)
+    {
+        mpz_clear(product[k]);
+    }
+
+    free(weights);
+    free(denominators);
+    free(product);
+
+    mpz_clears(diff, carry, NULL);
+}
+
+void lagrange_coefficients_at_zero(mpz_t *dst, mpz_point_t *shares, uint32_t size, mpz_t modulo)
+{
+    mpz_t zero;
+    mpz_init(zero);
+
+    lagrange_coefficients_at(dst, shares, zero, size, modulo);
+
+    mpz_clear(zero);
+}
+
+void mult_shamir_ss_batch(mpz_point_t **dst, mpz_point_t **shares_a, mpz_point_t **shares_b, uint32_t count, uint32_t size, uint32_t treshold, gmp_randstate_t prng, mpz_t modulo)
+{
+    mpz_t *lambda = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(lambda);
 
     for (uint32_t i = 0; i < size; i++)
     {
-        mpz_inits(tmp[i].y, tmp[i].x, NULL);
+        mpz_init(lambda[i]);
     }
 
+    // every product is reshared on the same abscissas: the degree reduction coefficients are
+    // computed once for all the components
+    lagrange_coefficients_at_zero(lambda, shares_a[0], size, modulo);
+
+    mult_shamir_ss_batch_lambda(dst, shares_a, shares_b, count, size, treshold, (const mpz_t *)lambda, prng, modulo);
+
     for (uint32_t i = 0; i < size; i++)
     {
-        for (uint32_t j = 0; j < size; j++)
+        mpz_clear(lambda[i]);
+    }
+
+    free(lambda);
+}
+
+void mult_shamir_ss_batch_lambda(mpz_point_t **dst, mpz_point_t **shares_a, mpz_point_t **shares_b, uint32_t count, uint32_t size, uint32_t treshold, const mpz_t *lambda, gmp_randstate_t prng, mpz_t modulo)
+{
+    mpz_t *polynomial = (mpz_t *)malloc(treshold * sizeof(mpz_t));
+    check_null_pointer(polynomial);
+
+    mpz_t *sums = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(sums);
+
+    unsigned long *powers = (unsigned long *)malloc(size * treshold * sizeof(unsigned long));
+    check_null_pointer(powers);
+
+    mpz_t evaluation;
+    mpz_init(evaluation);
+
+    for (uint32_t i = 0; i < treshold; i++)
+    {
+        mpz_init(polynomial[i]);
+    }
+
+    for (uint32_t k = 0; k < size; k++)
+    {
+        mpz_init(sums[k]);
+    }
+
+    // all the sets are on the same abscissas: one table serves every resharing of the batch
+    uint8_t table = polynomial_power_table(powers, shares_a[0], size, treshold);
+
+    for (uint32_t c = 0; c < count; c++)
+    {
+        for (uint32_t k = 0; k < size; k++)
         {
-            mpz_set_ui(tmp[j].x, j + 1);
-            mpz_set(tmp[j].y, shares[j][i].y);
+            mpz_set_ui(sums[k], 0);
+        }
+
+        // player i reshares its local product already weighted by its own lambda_i, so that
+        // the players only add up what they receive (the products are never combined in one place)
+        for (uint32_t i = 0; i < size; i++)
+        {
+            mpz_mul(polynomial[0], shares_a[c][i].y, shares_b[c][i].y);
+            mpz_mod(polynomial[0], polynomial[0], modulo);
+            mpz_mul(polynomial[0], polynomial[0], lambda[i]);
+            mpz_mod(polynomial[0], polynomial[0], modulo);
+
+            shamir_ss_accumulate(sums, shares_a[c], table ? powers : NULL, size, polynomial, treshold, evaluation, prng, modulo);
         }
 
-        mpz_set_ui(dst[i].x, i + 1);
-        lagrange_interpolation(dst[i].y, tmp, point, size, modulo);
+        // the products are all consumed, so dst may alias the inputs
+        for (uint32_t k = 0; k < size; k++)
+        {
+            mpz_set(dst[c][k].x, shares_a[c][k].x);
+            mpz_mod(dst[c][k].y, sums[k], modulo);
+        }
+    }
+
+    for (uint32_t i = 0; i < treshold; i++)
+    {
+        mpz_clear(polynomial[i]);
     }
 
-    mpz_clear(point);
+    for (uint32_t k = 0; k < size; k++)
+    {
+        mpz_clear(sums[k]);
+    }
+
+    free(polynomial);
+    free(sums);
+    free(powers);
+
+    mpz_clear(evaluation);
+}
+
+void mult_shamir_ss_batch_reshare(mpz_point_t **dst, mpz_point_t **shares_a, mpz_point_t **shares_b, uint32_t count, uint32_t size, uint32_t treshold, gmp_randstate_t prng, mpz_t modulo)
+{
+    mpz_t *lambda = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(lambda);
+
+    mpz_t *polynomial = (mpz_t *)malloc(treshold * sizeof(mpz_t));
+    check_null_pointer(polynomial);
+
+    mpz_t *accumulators = (mpz_t *)malloc(size * sizeof(mpz_t));
+    check_null_pointer(accumulators);
+
+    mpz_t evaluation;
+    mpz_init(evaluation);
 
     for (uint32_t i = 0; i < size; i++)
     {
-        for (uint32_t j = 0; j < size; j++)
+        mpz_inits(lambda[i], accumulators[i], NULL);
+    }
+
+    for (uint32_t i = 0; i < treshold; i++)
+    {
+        mpz_init(polynomial[i]);
+    }
+
+    // every product is reshared on the same abscissas: the degree reduction coefficients are
+    // computed once for all the components
+    lagrange_coefficients_at_zero(lambda, shares_a[0], size, modulo);
+
+    for (uint32_t c = 0; c < count; c++)
+    {
+        for (uint32_t k = 0; k < size; k++)
+        {
+            mpz_set_ui(accumulators[k], 0);
+        }
+
+        // player i reshares its local product, player k adds lambda_i times the received share
+        for (uint32_t i = 0; i < size; i++)
+        {
+            mpz_mul(polynomial[0], shares_a[c][i].y, shares_b[c][i].y);
+            mpz_mod(polynomial[0], polynomial[0], modulo);
+
+            polynomial_random_coefficients(polynomial, treshold, prng, modulo);
+
+            for (uint32_t k = 0; k < size; k++)
+            {
+                // Horner's method
+                mpz_set(evaluation, polynomial[treshold - 1]);
+
+                for (int32_t j = treshold - 2; j >= 0; j--)
+                {
+                    mpz_mul_ui(evaluation, evaluation, k + 1);
+                    mpz_add(evaluation, evaluation, polynomial[j]);
+                    mpz_mod(evaluation, evaluation, modulo);
+                }
+
+                mpz_addmul(accumulators[k], lambda[i], evaluation);
+            }
+        }
+
+        // the products are all consumed, so dst may alias the inputs
+        for (uint32_t k = 0; k < size; k++)
         {
-            mpz_clear_point(shares[i][j]);
+            mpz_set_ui(dst[c][k].x, k + 1);
+            mpz_mod(dst[c][k].y, accumulators[k], modulo);
         }
+    }
 
-        mpz_clear_point(tmp[i]);
-        free(shares[i]);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        mpz_clears(lambda[i], accumulators[i], NULL);
     }
 
-    free(tmp);
-    free(shares);
+    for (uint32_t i = 0; i < treshold; i++)
+    {
+        mpz_clear(polynomial[i]);
+    }
+
+    free(lambda);
+    free(accumulators);
+    free(polynomial);
+
+    mpz_clear(evaluation);
+}
+
+void mult_shamir_ss(mpz_point_t *dst, mpz_point_t *shares_a, mpz_point_t *shares_b, uint32_t size, uint32_t treshold, gmp_randstate_t prng, mpz_t modulo)
+{
+    mult_shamir_ss_batch(&dst, &shares_a, &shares_b, 1, size, treshold, prng, modulo);
 }